@@ -0,0 +1,154 @@
+#ifndef CONFIG_STORE_H
+#define CONFIG_STORE_H
+
+#include <Arduino.h>
+
+/*
+ * Журнальное хранилище настроек в EEPROM или её эмуляции.
+ * Область делится на слоты, и каждое сохранение пишется в следующий слот с большим номером записи.
+ * Оборванная запись оставляет целой предыдущую, а в побайтно записываемой EEPROM износ распределяется
+ * по всей области. Если Platform.h переписывает при сохранении всю страницу флеша (эмуляция EEPROM на STM32),
+ * износ не выравнивается: там ресурс бережёт только отложенная запись серии изменений.
+ * При загрузке берётся самая свежая запись с верными CRC, версией схемы и размером структуры.
+ * Доступ к памяти идёт через storageBegin/storageRead/storageWrite/storageEnd из Platform.h
+ * прошивки, поэтому Platform.h подключается раньше этого файла.
+ * Несколько хранилищ делят память, если у каждого своё смещение BASE за концом предыдущего.
+ */
+
+inline uint16_t crc16(const uint8_t value, uint16_t crc) {
+    crc ^= static_cast<uint16_t>(value) << 8;
+    for (uint8_t bit = 0; bit < 8; bit++) crc = crc & 0x8000 ? (crc << 1) ^ 0x1021 : crc << 1;
+    return crc;
+}
+
+inline uint16_t crc16(const void *data, const size_t length, uint16_t crc = 0xFFFF) {
+    const auto bytes = static_cast<const uint8_t *>(data);
+    for (size_t i = 0; i < length; i++) crc = crc16(bytes[i], crc);
+    return crc;
+}
+
+constexpr uint8_t CONFIG_MAGIC = 0x5A;
+
+struct __attribute__((packed)) ConfigRecord {
+    uint8_t magic;
+    uint8_t schema;
+    uint16_t length;
+    uint32_t sequence;
+};
+
+template<typename T, uint8_t SCHEMA, size_t SLOTS, size_t BASE = 0>
+class ConfigStore {
+public:
+    static constexpr size_t SLOT_SIZE = sizeof(ConfigRecord) + sizeof(T) + sizeof(uint16_t);
+    static constexpr size_t SIZE = SLOT_SIZE * SLOTS;
+    static constexpr size_t END = BASE + SIZE;
+    static_assert(SLOTS >= 2, "A torn write must leave a previous record to fall back to");
+
+    explicit ConfigStore(T &value) : value(value) {}
+
+    // Возвращает false, если целой записи текущей схемы нет и настройки надо заполнить по умолчанию.
+    bool load() {
+        storageBegin(END);
+        bool found = false;
+        for (size_t slot = 0; slot < SLOTS; slot++) {
+            ConfigRecord record;
+            read(slotAddress(slot), &record, sizeof(record));
+            if (record.magic != CONFIG_MAGIC || record.schema != SCHEMA || record.length != sizeof(T)) continue;
+            if (found && static_cast<int32_t>(record.sequence - sequence) <= 0) continue;
+            if (!valid(slot, record)) continue;
+
+            found = true;
+            current = slot;
+            sequence = record.sequence;
+        }
+        if (found) read(slotAddress(current) + sizeof(ConfigRecord), &value, sizeof(T));
+        storageEnd(false);
+        return found;
+    }
+
+    // Откладывает запись: серия изменений подряд сохраняется одной записью.
+    void save() {
+        if (!dirty) changed = millis();
+        dirty = true;
+    }
+
+    void task(const unsigned long delay) {
+        if (dirty && millis() - changed >= delay) commit();
+    }
+
+    void flush() {
+        if (dirty) commit();
+    }
+
+    void commit() {
+        const ConfigRecord record = {CONFIG_MAGIC, SCHEMA, sizeof(T), sequence + 1};
+        const uint16_t crc = crc16(&value, sizeof(T), crc16(&record, sizeof(record)));
+        const size_t slot = (current + 1) % SLOTS;
+
+        storageBegin(END);
+        write(slotAddress(slot), &record, sizeof(record));
+        write(slotAddress(slot) + sizeof(record), &value, sizeof(T));
+        write(slotAddress(slot) + sizeof(record) + sizeof(T), &crc, sizeof(crc));
+        storageEnd(true);
+
+        current = slot;
+        sequence = record.sequence;
+        dirty = false;
+    }
+
+    void erase() {
+        storageBegin(END);
+        for (size_t address = BASE; address < END; address++) storageWrite(address, 0xFF);
+        storageEnd(true);
+
+        current = SLOTS - 1;
+        sequence = 0;
+        dirty = false;
+    }
+
+    bool pending() const { return dirty; }
+
+    // Прошивки до журнального хранилища держали настройки одной структурой с адреса BASE, без заголовка и CRC.
+    // Читает её как есть: проверить значения и сохранить их в журнал должна прошивка.
+    template<typename L>
+    static void loadLegacy(L &legacy) {
+        storageBegin(END);
+        read(BASE, &legacy, sizeof(L));
+        storageEnd(false);
+    }
+
+    // Номер последней записи — сколько раз настройки сохранялись за жизнь памяти. Где каждое сохранение
+    // стирает одну и ту же страницу флеша, это и число её циклов стирания.
+    uint32_t writes() const { return sequence; }
+
+private:
+    T &value;
+    size_t current = SLOTS - 1;
+    uint32_t sequence = 0;
+    bool dirty = false;
+    unsigned long changed = 0;
+
+    static constexpr size_t slotAddress(const size_t slot) { return BASE + slot * SLOT_SIZE; }
+
+    static void read(const size_t address, void *data, const size_t length) {
+        const auto bytes = static_cast<uint8_t *>(data);
+        for (size_t i = 0; i < length; i++) bytes[i] = storageRead(address + i);
+    }
+
+    static void write(const size_t address, const void *data, const size_t length) {
+        const auto bytes = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < length; i++) storageWrite(address + i, bytes[i]);
+    }
+
+    static bool valid(const size_t slot, const ConfigRecord &record) {
+        const size_t address = slotAddress(slot) + sizeof(ConfigRecord);
+        uint16_t crc = crc16(&record, sizeof(record));
+        for (size_t i = 0; i < sizeof(T); i++) crc = crc16(storageRead(address + i), crc);
+
+        uint16_t stored;
+        read(address + sizeof(T), &stored, sizeof(stored));
+        return crc == stored;
+    }
+};
+
+#endif
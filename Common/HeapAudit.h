@@ -0,0 +1,69 @@
+#ifndef HEAP_AUDIT_H
+#define HEAP_AUDIT_H
+
+/*
+ * Проверочная сборка без выделений памяти на горячих путях.
+ * Включается флагами -DHEAP_AUDIT -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc: компоновщик направляет
+ * все вызовы malloc через обёртки ниже, и они считают выделения из наблюдаемой задачи.
+ * Задачу выдаёт platformTask() из Platform.h, поэтому Platform.h подключается раньше этого файла.
+ * Обёртки определены здесь же, и файл подключается в одну единицу трансляции прошивки.
+ * В обычной сборке файл пуст.
+ */
+
+#ifdef HEAP_AUDIT
+
+#include <Arduino.h>
+#include <atomic>
+#include <stdlib.h>
+
+inline void *heapAuditTask;
+inline std::atomic<unsigned long> heapAuditCount{0};
+
+// Дальше считаются только выделения из вызвавшей задачи; в однопоточной прошивке — все.
+inline void heapAuditWatch() { heapAuditTask = platformTask(); }
+
+inline unsigned long heapAllocations() { return heapAuditCount.load(std::memory_order_relaxed); }
+
+// Горячий путь, выделивший память после прогрева, — ошибка сборки-проверки: прошивка останавливается.
+inline void heapAuditCheck(const char *where, const unsigned long before) {
+    const unsigned long count = heapAllocations() - before;
+    if (count == 0) return;
+    Serial.print("Heap allocations in ");
+    Serial.print(where);
+    Serial.print(": ");
+    Serial.println(count);
+    Serial.flush();
+    abort();
+}
+
+extern "C" {
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+// Счётчик меняет только наблюдаемая задача, поэтому хватает загрузки и сохранения без атомарного сложения,
+// которого нет на Cortex-M0.
+inline void heapAuditNote() {
+    if (platformTask() != heapAuditTask) return;
+    heapAuditCount.store(heapAuditCount.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
+
+void *__wrap_malloc(const size_t size) {
+    heapAuditNote();
+    return __real_malloc(size);
+}
+
+void *__wrap_calloc(const size_t count, const size_t size) {
+    heapAuditNote();
+    return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, const size_t size) {
+    heapAuditNote();
+    return __real_realloc(pointer, size);
+}
+}
+
+#endif
+
+#endif
@@ -0,0 +1,135 @@
+#ifndef LOG_H
+#define LOG_H
+
+#include <Arduino.h>
+
+#include "LogMessages.h"
+#include "SpscQueue.h"
+
+/*
+ * Журнал без ожидания UART.
+ * LOG_ERROR/LOG_WARN/LOG_INFO/LOG_DEBUG кладут в очередь двоичную запись: номер сообщения из LogMessages.h,
+ * время и до LOG_ARGS_MAX целых аргументов. Фоновый logDrain() отдаёт записи в порт, только пока
+ * в буфере передатчика есть место, и текст из них собирает tools/logdecode.py на компьютере.
+ * Уровни ниже LOG_LEVEL не компилируются вовсе, вместе с вычислением аргументов.
+ * У каждого контекста исполнения (platformContext() из Platform.h) своя очередь с одним писателем,
+ * поэтому Platform.h подключается раньше этого файла.
+ */
+
+#define LOG_LEVEL_NONE 0
+#define LOG_LEVEL_ERROR 1
+#define LOG_LEVEL_WARN 2
+#define LOG_LEVEL_INFO 3
+#define LOG_LEVEL_DEBUG 4
+
+#ifndef LOG_LEVEL
+#define LOG_LEVEL LOG_LEVEL_INFO
+#endif
+
+constexpr unsigned long LOG_BAUD = 115200;
+constexpr size_t LOG_QUEUE_SIZE = 32;
+constexpr uint8_t LOG_ARGS_MAX = 5;
+constexpr uint8_t LOG_MAGIC = 0xA5;
+
+struct LogRecord {
+    uint16_t id;
+    uint8_t level;
+    uint8_t count;
+    uint32_t time;
+    int32_t args[LOG_ARGS_MAX];
+};
+
+// Счётчики меняет только владелец очереди, читать их можно откуда угодно.
+struct LogStats {
+    uint32_t written;
+    uint32_t dropped;
+};
+
+inline SpscQueue<LogRecord, LOG_QUEUE_SIZE> logQueues[LOG_CONTEXTS];
+inline LogStats logStats[LOG_CONTEXTS];
+inline uint32_t logBytes;
+
+template<typename... Args>
+void logWrite(const uint8_t level, const LogId id, const Args... args) {
+    static_assert(sizeof...(Args) <= LOG_ARGS_MAX, "Too many log arguments");
+    const LogRecord record = {id, level, sizeof...(Args), static_cast<uint32_t>(millis()), {static_cast<int32_t>(args)...}};
+    const size_t context = platformContext();
+    if (logQueues[context].push(record)) {
+        logStats[context].written++;
+    } else {
+        logStats[context].dropped++;
+    }
+}
+
+#if LOG_LEVEL >= LOG_LEVEL_ERROR
+#define LOG_ERROR(id, ...) logWrite(LOG_LEVEL_ERROR, id, ##__VA_ARGS__)
+#else
+#define LOG_ERROR(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_WARN
+#define LOG_WARN(id, ...) logWrite(LOG_LEVEL_WARN, id, ##__VA_ARGS__)
+#else
+#define LOG_WARN(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_INFO
+#define LOG_INFO(id, ...) logWrite(LOG_LEVEL_INFO, id, ##__VA_ARGS__)
+#else
+#define LOG_INFO(...) do {} while (0)
+#endif
+
+#if LOG_LEVEL >= LOG_LEVEL_DEBUG
+#define LOG_DEBUG(id, ...) logWrite(LOG_LEVEL_DEBUG, id, ##__VA_ARGS__)
+#else
+#define LOG_DEBUG(...) do {} while (0)
+#endif
+
+/*
+ * Запись в порту: LOG_MAGIC, уровень << 4 | число аргументов, номер (2 байта), время (4 байта),
+ * аргументы по 4 байта и сумма всех предыдущих байтов по модулю 256. Порядок байтов — little-endian.
+ */
+inline size_t logEncode(const LogRecord &record, uint8_t *buffer) {
+    size_t length = 0;
+    const auto put = [&](const uint32_t value, const uint8_t bytes) {
+        for (uint8_t i = 0; i < bytes; i++) buffer[length++] = value >> (8 * i);
+    };
+    put(LOG_MAGIC, 1);
+    put(record.level << 4 | record.count, 1);
+    put(record.id, 2);
+    put(record.time, 4);
+    for (uint8_t i = 0; i < record.count; i++) put(record.args[i], 4);
+
+    uint8_t sum = 0;
+    for (size_t i = 0; i < length; i++) sum += buffer[i];
+    buffer[length++] = sum;
+    return length;
+}
+
+// Отдаёт записи всех очередей, пока они помещаются в буфер передатчика; порт не ждёт никогда.
+inline void logDrain(Print &out) {
+    uint8_t buffer[9 + 4 * LOG_ARGS_MAX];
+    for (auto &queue: logQueues) {
+        while (!queue.empty()) {
+            const size_t length = logEncode(queue.front(), buffer);
+            if (out.availableForWrite() < static_cast<int>(length)) return;
+            out.write(buffer, length);
+            queue.pop();
+            logBytes += length;
+        }
+    }
+}
+
+inline uint32_t logWritten() {
+    uint32_t total = 0;
+    for (const LogStats &stats: logStats) total += stats.written;
+    return total;
+}
+
+inline uint32_t logDropped() {
+    uint32_t total = 0;
+    for (const LogStats &stats: logStats) total += stats.dropped;
+    return total;
+}
+
+#endif
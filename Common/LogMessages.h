@@ -0,0 +1,55 @@
+#ifndef LOG_MESSAGES_H
+#define LOG_MESSAGES_H
+
+/*
+ * Все сообщения журнала обеих прошивок. В запись попадает только номер строки и аргументы,
+ * а текст подставляет tools/logdecode.py, разбирая этот файл.
+ * Новые сообщения добавляются в конец: номера старых не меняются, и прежние записи читаются.
+ * Аргументы — только целые числа, спецификаторы — %d, %u, %x и %X с шириной.
+ */
+
+#define LOG_MESSAGES(X) \
+    X(LOG_CONFIG_LOADED, "Config loaded.") \
+    X(LOG_ZB_UNSUPPORTED, "ZigBee frame of unsupported version dropped.") \
+    X(LOG_ZB_FRAME, "ZigBee frame received: type %u seq %u") \
+    X(LOG_ZB_LEGACY, "ZigBee legacy payload from %08X: signal %d value %d") \
+    X(LOG_NODE_LEARNED, "Node learned: %08X") \
+    X(LOG_NODE_REGISTRY_FULL, "Node registry is full.") \
+    X(LOG_PENDING_DROPPED, "Pending command for %08X dropped.") \
+    X(LOG_COMMAND_NOT_DELIVERED, "Command %u to %08X not delivered.") \
+    X(LOG_DOWNLINK_DROPPED, "Downlink command for %08X dropped.") \
+    X(LOG_WIFI_CONNECTING, "Connecting to WiFi network...") \
+    X(LOG_WIFI_CONNECTING_CACHED, "Connecting to cached WiFi network on channel %u...") \
+    X(LOG_WIFI_CONNECTED, "WiFi connected: %u.%u.%u.%u") \
+    X(LOG_WIFI_NOT_CONNECTED, "WiFi not connected.") \
+    X(LOG_WIFI_LOST, "WiFi connection lost.") \
+    X(LOG_WIFI_CACHE_DROPPED, "Cached WiFi parameters dropped.") \
+    X(LOG_WIFI_HOST, "WiFi host is started on %u.%u.%u.%u") \
+    X(LOG_DEVICE_REGISTERING, "Registering device %08X...") \
+    X(LOG_DEVICE_REGISTERED, "Device %08X registered as %d.") \
+    X(LOG_BROKER_FETCHING, "Fetching broker data...") \
+    X(LOG_BROKER_FETCHED, "Broker data fetched.") \
+    X(LOG_MQTT_CONNECTING, "Connecting to MQTT broker...") \
+    X(LOG_MQTT_CONNECTED, "MQTT connected.") \
+    X(LOG_MQTT_NOT_CONNECTED, "MQTT not connected.") \
+    X(LOG_MQTT_LOST, "MQTT connection lost.") \
+    X(LOG_MQTT_COMMAND, "MQTT command for %08X: signal %d zone %u") \
+    X(LOG_MQTT_RANGE, "MQTT value %d out of range for signal %d.") \
+    X(LOG_FORECAST_CACHED, "Forecast not updated, using cached one.") \
+    X(LOG_BOOT, "Boot: radio=%ums wifi=%ums mqtt=%ums fast=%u") \
+    X(LOG_TASK, "Task %u/%u: runs=%u avg=%uus max=%uus") \
+    X(LOG_CONFIG_WRITES, "Config writes: %u") \
+    X(LOG_HOST_READY, "Host is set up.") \
+    X(LOG_CLIENT_READY, "Client is set up.") \
+    X(LOG_STATE_DIFF, "Settings of %08X differ from shadow: %u sent.") \
+    X(LOG_ZB_VERSION, "ZigBee peer speaks protocol version %u, falling back to text commands.") \
+    X(LOG_WIFI_LEASE_EXPIRED, "WiFi address lease may expire, reconnecting with DHCP.") \
+    X(LOG_CONFIG_IMPORTED, "Config imported from the legacy layout.")
+
+#define LOG_MESSAGE_ID(name, text) name,
+
+typedef enum : uint16_t { LOG_MESSAGES(LOG_MESSAGE_ID) LOG_MESSAGE_COUNT } LogId;
+
+#undef LOG_MESSAGE_ID
+
+#endif
@@ -0,0 +1,352 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Бинарный протокол между устройством и хабом.
+ * Кадр начинается с PROTOCOL_MAGIC, который не может быть первым байтом
+ * ASCII-команды вида CMD=VALUE, поэтому оба формата различаются по первому байту.
+ * Все поля однобайтово выровнены и читаются прямо из rx.getData().
+ */
+
+constexpr uint8_t PROTOCOL_MAGIC = 0xA5;
+constexpr uint8_t PROTOCOL_VERSION = 5;
+constexpr uint8_t PROTOCOL_PAYLOAD_MAX = 84;
+
+constexpr uint8_t FORECAST_HOURS = 24;
+constexpr uint8_t ZONES_MAX = 8;
+constexpr uint8_t TELEMETRY_BATCH = 4;
+
+typedef enum : uint8_t {
+    MESSAGE_TELEMETRY = 1,
+    MESSAGE_REFERENCE = 2,
+    MESSAGE_MODE = 3,
+    MESSAGE_RAIN = 4,
+    MESSAGE_FORECAST = 5,
+    MESSAGE_LOOKAHEAD = 6,
+    MESSAGE_CALIBRATION = 7,
+    MESSAGE_ACK = 8,
+    MESSAGE_DEADBAND = 9,
+    MESSAGE_HEARTBEAT = 10,
+    MESSAGE_STATS = 11,
+    MESSAGE_WATERING = 12,
+    MESSAGE_SLEEP = 13,
+    MESSAGE_LINK_ACK = 14,
+    MESSAGE_STATE = 15,
+    MESSAGE_TIME = 16,
+} MessageType;
+
+// Время в секундах не меньше этого — unix-время по синхронизированным часам, меньше — время с загрузки устройства.
+constexpr uint32_t TIME_EPOCH_MIN = 1700000000;
+
+/*
+ * Сигналы между устройством, хабом и брокером: команды идут от брокера к устройству, отчёты — обратно.
+ * Таблица SIGNALS — единственное место, где заданы ASCII-имя устаревшего формата, топик MQTT,
+ * бинарный тип кадра и допустимый диапазон значения. Новый сигнал — это строка таблицы и значение Signal.
+ */
+
+typedef enum : uint8_t {
+    SIGNAL_REFERENCE,
+    SIGNAL_MODE,
+    SIGNAL_RAIN,
+    SIGNAL_VALUE,
+    SIGNAL_STATUS,
+    SIGNAL_WATER,
+    SIGNAL_LOOKAHEAD,
+    SIGNAL_CALIBRATION,
+    SIGNAL_DEADBAND,
+    SIGNAL_HEARTBEAT,
+    SIGNAL_SLEEP,
+    SIGNAL_COUNT,
+    SIGNAL_NONE = SIGNAL_COUNT,
+} Signal;
+
+typedef enum : uint8_t { SIGNAL_COMMAND, SIGNAL_REPORT } SignalDirection;
+
+typedef enum : uint8_t { VALUE_INT, VALUE_CALIBRATION } ValueType;
+
+constexpr uint32_t signalHash(const char *text, const uint32_t hash = 2166136261u) {
+    return *text ? signalHash(text + 1, (hash ^ static_cast<uint8_t>(*text)) * 16777619u) : hash;
+}
+
+struct SignalSpec {
+    Signal id;
+    SignalDirection direction;
+    MessageType type;
+    const char *legacy;
+    const char *topic;
+    bool zoned;
+    ValueType value;
+    int16_t min;
+    int16_t max;
+    uint32_t legacyHash;
+    uint32_t topicHash;
+
+    constexpr SignalSpec(const Signal id, const SignalDirection direction, const MessageType type, const char *legacy,
+                         const char *topic, const bool zoned, const ValueType value, const int16_t min, const int16_t max)
+        : id(id), direction(direction), type(type), legacy(legacy), topic(topic), zoned(zoned), value(value), min(min),
+          max(max), legacyHash(legacy ? signalHash(legacy) : 0), topicHash(topic ? signalHash(topic) : 0) {}
+};
+
+constexpr SignalSpec SIGNALS[] = {
+    {SIGNAL_REFERENCE, SIGNAL_COMMAND, MESSAGE_REFERENCE, "REFERENCE", "moisture/reference", true, VALUE_INT, 0, 100},
+    {SIGNAL_MODE, SIGNAL_COMMAND, MESSAGE_MODE, "MODE", "watering/mode", true, VALUE_INT, 1, 3},
+    {SIGNAL_RAIN, SIGNAL_COMMAND, MESSAGE_RAIN, "RAIN", nullptr, false, VALUE_INT, 0, 1},
+    {SIGNAL_VALUE, SIGNAL_REPORT, MESSAGE_TELEMETRY, "VALUE", "moisture/value", true, VALUE_INT, 0, 100},
+    {SIGNAL_STATUS, SIGNAL_REPORT, MESSAGE_TELEMETRY, "STATUS", "watering/status", true, VALUE_INT, 0, 1},
+    {SIGNAL_WATER, SIGNAL_REPORT, MESSAGE_TELEMETRY, "WATER", "water/level", false, VALUE_INT, 0, 1},
+    {SIGNAL_LOOKAHEAD, SIGNAL_COMMAND, MESSAGE_LOOKAHEAD, nullptr, "watering/lookahead", false, VALUE_INT, 1, FORECAST_HOURS},
+    {SIGNAL_CALIBRATION, SIGNAL_COMMAND, MESSAGE_CALIBRATION, nullptr, "moisture/calibration", true, VALUE_CALIBRATION, 0, 0},
+    {SIGNAL_DEADBAND, SIGNAL_COMMAND, MESSAGE_DEADBAND, nullptr, "report/deadband", false, VALUE_INT, 0, 100},
+    {SIGNAL_HEARTBEAT, SIGNAL_COMMAND, MESSAGE_HEARTBEAT, nullptr, "report/heartbeat", false, VALUE_INT, 1, 24 * 60},
+    {SIGNAL_SLEEP, SIGNAL_COMMAND, MESSAGE_SLEEP, nullptr, "power/sleep", false, VALUE_INT, 0, 1},
+};
+
+constexpr bool signalsOrdered(const size_t i = 0) {
+    return i == SIGNAL_COUNT || (SIGNALS[i].id == i && signalsOrdered(i + 1));
+}
+
+constexpr bool signalsUnique(const size_t i = 0, const size_t j = 1) {
+    return i + 1 >= SIGNAL_COUNT ? true
+        : j >= SIGNAL_COUNT ? signalsUnique(i + 1, i + 2)
+        : (SIGNALS[i].legacyHash == 0 || SIGNALS[i].legacyHash != SIGNALS[j].legacyHash) &&
+          (SIGNALS[i].topicHash == 0 || SIGNALS[i].topicHash != SIGNALS[j].topicHash) && signalsUnique(i, j + 1);
+}
+
+static_assert(sizeof(SIGNALS) / sizeof(SIGNALS[0]) == SIGNAL_COUNT, "Every signal needs a table row");
+static_assert(signalsOrdered(), "Table rows must follow the Signal order");
+static_assert(signalsUnique(), "Signal names collide by hash");
+
+// Поиск сравнивает только хеши, так что на входящий кадр приходится один проход по строке и один strcmp для проверки.
+inline Signal signalByLegacy(const char *name) {
+    const uint32_t hash = signalHash(name);
+    for (const SignalSpec &spec: SIGNALS) {
+        if (spec.legacyHash == hash && strcmp(spec.legacy, name) == 0) return spec.id;
+    }
+    return SIGNAL_NONE;
+}
+
+inline Signal signalByTopic(const char *topic) {
+    const uint32_t hash = signalHash(topic);
+    for (const SignalSpec &spec: SIGNALS) {
+        if (spec.topicHash == hash && strcmp(spec.topic, topic) == 0) return spec.id;
+    }
+    return SIGNAL_NONE;
+}
+
+inline Signal signalByType(const MessageType type) {
+    for (const SignalSpec &spec: SIGNALS) {
+        if (spec.direction == SIGNAL_COMMAND && spec.type == type) return spec.id;
+    }
+    return SIGNAL_NONE;
+}
+
+// Настройки, которые устройство хранит у себя, а хаб — в тени; стороны сверяют их кадром StateFrame.
+constexpr Signal STATE_SIGNALS[] = {
+    SIGNAL_REFERENCE, SIGNAL_MODE, SIGNAL_LOOKAHEAD, SIGNAL_DEADBAND, SIGNAL_HEARTBEAT, SIGNAL_SLEEP,
+};
+
+constexpr uint8_t stateEntriesMax(const size_t i = 0) {
+    return i == sizeof(STATE_SIGNALS) / sizeof(STATE_SIGNALS[0])
+        ? 0
+        : (SIGNALS[STATE_SIGNALS[i]].zoned ? ZONES_MAX : 1) + stateEntriesMax(i + 1);
+}
+
+constexpr uint8_t STATE_ENTRIES_MAX = stateEntriesMax();
+
+inline bool signalIsState(const Signal signal) {
+    for (const Signal state: STATE_SIGNALS) if (state == signal) return true;
+    return false;
+}
+
+// seq — номер команды хаба, по которому приходит LinkAckFrame; 0 у кадров, которые не подтверждаются.
+struct __attribute__((packed)) FrameHeader {
+    uint8_t magic;
+    uint8_t version;
+    MessageType type;
+    uint8_t seq;
+};
+
+// Замер одного цикла. time — время устройства в секундах (см. TIME_EPOCH_MIN), seq растёт на единицу с каждым замером.
+// status — битовая маска открытых клапанов, бит i соответствует зоне i.
+struct __attribute__((packed)) Sample {
+    uint16_t seq;
+    uint32_t time;
+    uint8_t water;
+    uint8_t status;
+    uint8_t moisture[ZONES_MAX];
+};
+
+// Счётчики радиосвязи устройства по модулю 2^16; едут в каждом пакете телеметрии, без отдельного кадра.
+// loopMax — самая долгая итерация loop() без сна с прошлого пакета, мс.
+struct __attribute__((packed)) DeviceCounters {
+    uint16_t framesIn;
+    uint16_t framesOut;
+    uint16_t framesInvalid;
+    uint16_t loopMax;
+};
+
+// Пакет из count самых старых неподтверждённых замеров; передаются только первые count элементов samples.
+// session меняется при каждой загрузке устройства, now — время устройства в момент отправки.
+struct __attribute__((packed)) TelemetryFrame {
+    FrameHeader header;
+    uint8_t session;
+    uint32_t now;
+    uint8_t zones;
+    uint8_t count;
+    DeviceCounters counters;
+    Sample samples[TELEMETRY_BATCH];
+};
+
+constexpr uint8_t telemetryFrameSize(const uint8_t count) {
+    return sizeof(TelemetryFrame) - sizeof(Sample) * (TELEMETRY_BATCH - count);
+}
+
+static_assert(sizeof(TelemetryFrame) <= PROTOCOL_PAYLOAD_MAX, "Telemetry batch does not fit into one frame");
+
+// Подтверждение приёма замеров с номерами от first до last включительно.
+struct __attribute__((packed)) AckFrame {
+    FrameHeader header;
+    uint16_t first;
+    uint16_t last;
+};
+
+// Счётчики устройства с момента загрузки.
+struct __attribute__((packed)) StatsFrame {
+    FrameHeader header;
+    uint32_t reportsSent;
+    uint32_t reportsSuppressed;
+    uint32_t samplesDropped;
+    uint32_t awake;
+    uint32_t asleep;
+    uint32_t configWrites;
+    uint32_t radioFailures;
+    uint32_t logWritten;
+    uint32_t logDropped;
+};
+
+// Завершённый полив зоны: длительность в секундах, оценка объёма в миллилитрах и время окончания
+// по часам устройства (0 — часы ещё не синхронизированы).
+struct __attribute__((packed)) WateringFrame {
+    FrameHeader header;
+    uint8_t zone;
+    uint16_t duration;
+    uint32_t volume;
+    uint32_t time;
+};
+
+struct __attribute__((packed)) LinkAckFrame {
+    FrameHeader header;
+    uint8_t seq;
+};
+
+struct __attribute__((packed)) Timestamp {
+    uint32_t seconds;
+    uint16_t milliseconds;
+};
+
+// Синхронизация часов по схеме NTP. Устройство шлёт запрос с origin — своим временем отправки в мс —
+// и итогами прошлой синхронизации: задержкой туда и обратно (0xFFFF — ещё не было), поправкой часов в мс
+// и оценкой ухода в ppm. Хаб возвращает кадр без подтверждения, дописав время приёма и отправки по своим часам.
+struct __attribute__((packed)) TimeFrame {
+    FrameHeader header;
+    uint32_t origin;
+    uint16_t delay;
+    int16_t error;
+    int16_t drift;
+    Timestamp received;
+    Timestamp sent;
+};
+
+inline uint64_t timestampMillis(const Timestamp &time) { return time.seconds * 1000ull + time.milliseconds; }
+
+inline bool seqBefore(const uint16_t a, const uint16_t b) { return static_cast<int16_t>(a - b) < 0; }
+
+// Значение одной настройки; zone не используется у настроек всего устройства.
+struct __attribute__((packed)) StateEntry {
+    Signal signal;
+    uint8_t zone;
+    int16_t value;
+};
+
+// Сверка настроек; число записей определяется по длине кадра.
+// От устройства — все его настройки: после загрузки, восстановления связи и любого изменения.
+// От хаба — только значения, расходящиеся с желаемыми; пустой кадр просит устройство прислать отчёт.
+struct __attribute__((packed)) StateFrame {
+    FrameHeader header;
+    StateEntry entries[STATE_ENTRIES_MAX];
+};
+
+static_assert(sizeof(StateFrame) <= PROTOCOL_PAYLOAD_MAX, "Device settings do not fit into one state report");
+
+constexpr uint8_t stateFrameSize(const uint8_t count) { return sizeof(FrameHeader) + sizeof(StateEntry) * count; }
+
+constexpr uint8_t stateFrameCount(const uint8_t length) {
+    return length < sizeof(FrameHeader) ? 0 : (length - sizeof(FrameHeader)) / sizeof(StateEntry);
+}
+
+// zone — номер зоны с нуля; для команд, относящихся ко всему устройству, не используется.
+struct __attribute__((packed)) CommandFrame {
+    FrameHeader header;
+    uint8_t zone;
+    int16_t value;
+};
+
+// Точки калибровки датчика зоны в отсчётах АЦП.
+// CALIBRATION_CURRENT берёт текущее отфильтрованное значение, CALIBRATION_KEEP оставляет точку как есть.
+constexpr int16_t CALIBRATION_CURRENT = -1;
+constexpr int16_t CALIBRATION_KEEP = -2;
+
+struct __attribute__((packed)) CalibrationFrame {
+    FrameHeader header;
+    uint8_t zone;
+    int16_t dry;
+    int16_t wet;
+};
+
+// Осадки по часам в десятых долях мм; rain[0] относится к часу, начинающемуся в time.
+// now — время хаба в момент отправки, по нему устройство находит текущий час.
+struct __attribute__((packed)) ForecastFrame {
+    FrameHeader header;
+    uint32_t time;
+    uint32_t now;
+    uint8_t rain[FORECAST_HOURS];
+};
+
+inline bool frameIsBinary(const uint8_t *data, const uint8_t length) {
+    return length > 0 && data[0] == PROTOCOL_MAGIC;
+}
+
+// Кадр другой версии разобрать нельзя. С таким собеседником обе стороны переходят на ASCII-команды:
+// их понимает прошивка любой версии, и смешанный парк продолжает работать до обновления.
+inline bool frameIsCompatible(const uint8_t *data, const uint8_t length) {
+    return frameIsBinary(data, length) && length >= 2 && data[1] == PROTOCOL_VERSION;
+}
+
+inline const FrameHeader *frameHeader(const uint8_t *data, const uint8_t length) {
+    if (length < sizeof(FrameHeader)) return nullptr;
+    const auto header = reinterpret_cast<const FrameHeader *>(data);
+    if (header->magic != PROTOCOL_MAGIC || header->version != PROTOCOL_VERSION) return nullptr;
+    return header;
+}
+
+template<typename T>
+const T *frameAs(const uint8_t *data, const uint8_t length) {
+    if (length < sizeof(T)) return nullptr;
+    return reinterpret_cast<const T *>(data);
+}
+
+inline FrameHeader frameHeaderOf(const MessageType type) { return {PROTOCOL_MAGIC, PROTOCOL_VERSION, type, 0}; }
+
+// Кадр с заголовком и нулями во всех остальных полях.
+template<typename T>
+T frameOf(const MessageType type) {
+    T frame = {};
+    frame.header = frameHeaderOf(type);
+    return frame;
+}
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <stddef.h>
+
+/*
+ * Кольцевой буфер фиксированной ёмкости без динамической памяти.
+ * При переполнении push() вытесняет самый старый элемент.
+ */
+
+template<typename T, size_t N>
+class RingBuffer {
+public:
+    bool empty() const { return count == 0; }
+    bool full() const { return count == N; }
+    size_t size() const { return count; }
+    static constexpr size_t capacity() { return N; }
+
+    T &operator[](const size_t index) { return items[(tail + index) % N]; }
+    const T &operator[](const size_t index) const { return items[(tail + index) % N]; }
+
+    T &front() { return items[tail]; }
+    T &back() { return items[(tail + count - 1) % N]; }
+
+    // Возвращает false, если ради нового элемента пришлось вытеснить самый старый.
+    bool push(const T &item) {
+        const bool overwrite = full();
+        if (overwrite) pop();
+        items[(tail + count) % N] = item;
+        count++;
+        return !overwrite;
+    }
+
+    void pop() {
+        if (count == 0) return;
+        tail = (tail + 1) % N;
+        count--;
+    }
+
+    void clear() {
+        tail = 0;
+        count = 0;
+    }
+
+private:
+    T items[N];
+    size_t tail = 0;
+    size_t count = 0;
+};
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <atomic>
+#include <stddef.h>
+
+/*
+ * Очередь без блокировок между двумя задачами: push() вызывает только одна задача, front()/pop() — только другая.
+ * Каждая сторона пишет лишь свой счётчик, поэтому хватает атомарных загрузок и сохранений без мьютексов.
+ * В отличие от RingBuffer, полная очередь не вытесняет старое: что делать с новым элементом, решает производитель.
+ */
+
+template<typename T, size_t N>
+class SpscQueue {
+public:
+    static_assert(N > 0 && (N & (N - 1)) == 0, "Free-running counters need a power-of-two capacity");
+
+    static constexpr size_t capacity() { return N; }
+
+    size_t size() const { return head.load(std::memory_order_acquire) - tail.load(std::memory_order_acquire); }
+    size_t space() const { return N - size(); }
+    bool empty() const { return size() == 0; }
+
+    // Наибольшая заполненность за всё время: видно, хватает ли ёмкости.
+    size_t highWater() const { return high.load(std::memory_order_relaxed); }
+
+    // Производитель.
+    bool push(const T &item) {
+        const size_t position = head.load(std::memory_order_relaxed);
+        const size_t used = position - tail.load(std::memory_order_acquire);
+        if (used == N) return false;
+
+        items[position % N] = item;
+        head.store(position + 1, std::memory_order_release);
+        if (used + 1 > high.load(std::memory_order_relaxed)) high.store(used + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Потребитель: элемент остаётся на месте до pop(), так что его можно обработать без копии.
+    T &front() { return items[tail.load(std::memory_order_relaxed) % N]; }
+
+    void pop() {
+        const size_t position = tail.load(std::memory_order_relaxed);
+        if (position == head.load(std::memory_order_acquire)) return;
+        tail.store(position + 1, std::memory_order_release);
+    }
+
+private:
+    T items[N];
+    std::atomic<size_t> head{0};
+    std::atomic<size_t> tail{0};
+    std::atomic<size_t> high{0};
+};
+
+#endif
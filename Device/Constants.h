@@ -5,24 +5,66 @@
 
 #define PIN_XBEE_RX 27
 #define PIN_XBEE_TX 26
+#define PIN_XBEE_SLEEP 28
+
+constexpr XBeeAddress64 XBEE_ADDRESS_COORDINATOR(0x00000000, 0x00000000);
 
 constexpr int PIN_MOIST[] = {A0, A1, A2, A3, A4, A5, A6, A7};
+constexpr int PIN_VALVE[] = {2, 3, 4, 5, 6, 7, 8, 9};
 #define PIN_WATER A8
 #define PIN_WATERING A9
 
-constexpr char XBEE_COMMAND_REFERENCE[] = "REFERENCE";
-constexpr char XBEE_COMMAND_VALUE[] = "VALUE";
-constexpr char XBEE_COMMAND_MODE[] = "MODE";
-constexpr char XBEE_COMMAND_STATUS[] = "STATUS";
-constexpr char XBEE_COMMAND_WATER[] = "WATER";
-constexpr char XBEE_COMMAND_RAIN[] = "RAIN";
+constexpr uint8_t ZONES = sizeof(PIN_MOIST) / sizeof(PIN_MOIST[0]);
+static_assert(ZONES <= ZONES_MAX, "Too many moisture channels for one telemetry frame");
+static_assert(sizeof(PIN_VALVE) == sizeof(PIN_MOIST), "Every zone needs a valve pin");
 
 constexpr char MODE_OFF[] = "1";
 constexpr char MODE_ON[] = "2";
 constexpr char MODE_AUTO[] = "3";
 
-constexpr long EEPROM_SIZE = sizeof(Config);
+constexpr uint8_t CONFIG_SCHEMA = 1;
+constexpr size_t CONFIG_SLOTS = 4;
+constexpr long CONFIG_COMMIT_DELAY = 1000l * 5l;
+
 constexpr long UPDATE_INTERVAL = 1000l * 60l;
-constexpr long WEATHER_INTERVAL = 1000l * 60l * 60l * 24l;
+constexpr long UPDATE_INTERVAL_MIN = 1000l * 15l;
+constexpr long UPDATE_INTERVAL_MAX = 1000l * 60l * 5l;
+constexpr int UPDATE_MARGIN = 20;
+constexpr long STATS_INTERVAL = 1000l * 60l * 10l;
+
+constexpr uint8_t REPORT_DEADBAND = 2;
+constexpr uint16_t REPORT_HEARTBEAT = 15;
+
+constexpr uint8_t LINK_DEDUP = 8;
+constexpr long LINK_DEDUP_TIME = 1000l * 30l;
+
+constexpr long RADIO_AWAKE_WINDOW = 500l;
+constexpr long XBEE_WAKE_TIME = 15l;
+constexpr long SLEEP_MIN = 100l;
+
+constexpr unsigned long TIME_SYNC_INTERVAL = 1000ul * 60ul * 60ul;
+constexpr unsigned long TIME_SYNC_RETRY = 1000ul * 60ul;
+// Ответ, шедший дольше, даёт слишком грубую оценку смещения и отбрасывается.
+constexpr uint16_t TIME_DELAY_MAX = 2000;
+// Уход оценивается только на интервале не короче этого: иначе в нём преобладает разброс задержки.
+constexpr unsigned long TIME_DRIFT_WINDOW = 1000ul * 60ul * 10ul;
+constexpr int32_t TIME_DRIFT_MAX = 20000;
+
+constexpr long DRAIN_INTERVAL = 1000l * 2l;
+constexpr unsigned long DRAIN_INTERVAL_MAX = UPDATE_INTERVAL;
+constexpr size_t SAMPLES_MAX = 256;
+
+constexpr long SAMPLE_INTERVAL = 50l;
+constexpr uint8_t OVERSAMPLING = 16;
+constexpr int ADC_MAX = 1023;
+
+constexpr long WATERING_INTERVAL = 1000l;
+constexpr long WATERING_RUN_MAX = 1000l * 60l * 10l;
+constexpr long WATERING_OFF_MIN = 1000l * 60l * 5l;
+constexpr int WATERING_HYSTERESIS = 3;
+// Расход одной зоны, мл/мин.
+constexpr unsigned long WATERING_FLOW = 2000;
 
 constexpr int MIN_MOIST = 1;
+constexpr uint8_t MIN_RAIN = 1;
+constexpr uint8_t RAIN_LOOKAHEAD = 6;
@@ -0,0 +1,46 @@
+#ifndef FILTER_H
+#define FILTER_H
+
+#include <stdint.h>
+#include <string.h>
+
+/*
+ * Фильтр канала датчика влажности: медиана последних FILTER_WINDOW отсчётов снимает одиночные выбросы,
+ * а экспоненциальное сглаживание поверх неё — шум. Значение хранится в FILTER_SCALE раз точнее АЦП,
+ * чтобы деление на FILTER_SMOOTHING не съедало малые изменения.
+ */
+
+constexpr uint8_t FILTER_WINDOW = 5;
+constexpr int32_t FILTER_SCALE = 16;
+constexpr int32_t FILTER_SMOOTHING = 4;
+
+struct Channel {
+    uint16_t samples[FILTER_WINDOW];
+    uint8_t head;
+    uint8_t count;
+    int32_t filtered;
+};
+
+inline uint16_t channelMedian(const Channel &channel) {
+    uint16_t sorted[FILTER_WINDOW];
+    memcpy(sorted, channel.samples, channel.count * sizeof(sorted[0]));
+    for (uint8_t i = 1; i < channel.count; i++) {
+        for (uint8_t j = i; j > 0 && sorted[j - 1] > sorted[j]; j--) {
+            const uint16_t swap = sorted[j];
+            sorted[j] = sorted[j - 1];
+            sorted[j - 1] = swap;
+        }
+    }
+    return sorted[channel.count / 2];
+}
+
+inline void channelSample(Channel &channel, const uint16_t raw) {
+    channel.samples[channel.head] = raw;
+    channel.head = (channel.head + 1) % FILTER_WINDOW;
+    if (channel.count < FILTER_WINDOW) channel.count++;
+
+    const int32_t median = static_cast<int32_t>(channelMedian(channel)) * FILTER_SCALE;
+    channel.filtered = channel.count == 1 ? median : channel.filtered + (median - channel.filtered) / FILTER_SMOOTHING;
+}
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <EEPROM.h>
+#if defined(ARDUINO_ARCH_STM32)
+#include <STM32LowPower.h>
+#include <STM32RTC.h>
+#endif
+
+/*
+ * Платформенно-зависимая часть прошивки устройства.
+ * Остальной код работает с железом только через Arduino API и эти функции,
+ * поэтому сборка под другую плату или под хост сводится к замене этого файла.
+ */
+
+inline HardwareSerial &radioSerial() {
+#if defined(ARDUINO_ARCH_STM32)
+    static HardwareSerial serial(PIN_XBEE_RX, PIN_XBEE_TX);
+    return serial;
+#else
+    return Serial2;
+#endif
+}
+
+// Усреднённое значение канала АЦП; на платах с DMA-сканированием АЦП заменяется здесь.
+inline uint16_t adcRead(const int pin, const uint8_t samples) {
+    uint32_t sum = 0;
+    for (uint8_t i = 0; i < samples; i++) sum += analogRead(pin);
+    return sum / samples;
+}
+
+// Прошивка однопоточная: все выделения памяти относятся к одной задаче.
+inline void *platformTask() { return nullptr; }
+
+constexpr size_t LOG_CONTEXTS = 1;
+
+inline size_t platformContext() { return 0; }
+
+inline void sleepBegin() {
+#if defined(ARDUINO_ARCH_STM32)
+    LowPower.begin();
+    LowPower.enableWakeupFrom(&radioSerial(), [] {});
+#endif
+}
+
+// Stop-режим до будильника RTC или до байта от радиомодуля; возвращает время сна в миллисекундах.
+// В stop-режиме SysTick остановлен, поэтому millis() догоняется по RTC.
+inline unsigned long sleepFor([[maybe_unused]] const unsigned long timeout) {
+#if defined(ARDUINO_ARCH_STM32)
+    STM32RTC &rtc = STM32RTC::getInstance();
+    uint32_t before;
+    uint32_t after;
+    const uint32_t epochBefore = rtc.getEpoch(&before);
+    LowPower.deepSleep(timeout);
+    const uint32_t epochAfter = rtc.getEpoch(&after);
+
+    const unsigned long slept = (epochAfter - epochBefore) * 1000ul + after - before;
+    uwTick += slept;
+    return slept;
+#else
+    return 0;
+#endif
+}
+
+// E2END — последний адрес EEPROM ядра; на STM32 это размер эмуляции, то есть одна страница флеша.
+constexpr size_t STORAGE_SIZE = E2END + 1;
+
+#if defined(ARDUINO_ARCH_STM32)
+// Буферизованная эмуляция: страница флеша стирается и пишется один раз за storageEnd(true), а не на каждый байт.
+// Эмуляция занимает одну страницу, поэтому выравнивания износа здесь нет: каждое сохранение стирает её целиком,
+// и счётчик config/writes равен числу циклов стирания, которое сравнивается с ресурсом флеша (около 10 тыс.).
+// Ротация слотов на этой плате защищает только от оборванной записи.
+inline void storageBegin(const size_t) { eeprom_buffer_fill(); }
+
+inline uint8_t storageRead(const size_t address) { return eeprom_buffered_read_byte(address); }
+
+inline void storageWrite(const size_t address, const uint8_t value) { eeprom_buffered_write_byte(address, value); }
+
+inline void storageEnd(const bool commit) {
+    if (commit) eeprom_buffer_flush();
+}
+#else
+inline void storageBegin(const size_t) { EEPROM.begin(); }
+
+inline uint8_t storageRead(const size_t address) { return EEPROM.read(address); }
+
+// update() не трогает ячейку, если значение не изменилось.
+inline void storageWrite(const size_t address, const uint8_t value) { EEPROM.update(address, value); }
+
+inline void storageEnd(const bool) { EEPROM.end(); }
+#endif
+
+#endif
@@ -2,9 +2,53 @@
 #define STRUCTS_H
 #endif
 
+#include "../Common/Protocol.h"
+
 typedef enum { OFF, ON, AUTO  } Mode;
 
-struct Config {
+struct Zone {
+    int reference;
+    Mode mode;
+    int dry;
+    int wet;
+};
+
+// Config прошивок до журнального хранилища: одна уставка и режим на все зоны с адреса 0.
+struct LegacyConfig {
     int reference;
     Mode mode;
-};
\ No newline at end of file
+};
+
+struct Config {
+    Zone zones[ZONES_MAX];
+    uint8_t lookahead;
+    uint8_t deadband;
+    uint16_t heartbeat;
+    uint8_t sleep;
+};
+
+struct Valve {
+    bool open;
+    unsigned long opened;
+    unsigned long closed;
+};
+
+// Модель часов по последней синхронизации: время хаба = local + offset + (local - base) * drift / 10^6, в мс.
+// local — собственное время устройства, millis() без переполнения; requested — время последнего запроса.
+struct Clock {
+    bool synced;
+    uint64_t base;
+    int64_t offset;
+    int32_t drift;
+    uint16_t delay;
+    int16_t error;
+    uint64_t requested;
+};
+
+struct Forecast {
+    bool valid;
+    uint32_t time;
+    uint32_t now;
+    unsigned long received;
+    uint8_t rain[FORECAST_HOURS];
+};
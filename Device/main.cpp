@@ -3,123 +3,735 @@
 #include <XBee.h>
 
 #include "Constants.h"
+#include "Filter.h"
+#include "Platform.h"
+#include "../Common/ConfigStore.h"
+#include "../Common/HeapAudit.h"
+#include "../Common/Log.h"
+#include "../Common/Protocol.h"
+#include "../Common/RingBuffer.h"
 
-HardwareSerial Serial2(PIN_XBEE_RX, PIN_XBEE_TX);
 XBeeWithCallbacks xbeeClient;
 
 Config config;
-bool rainSoon;
+ConfigStore<Config, CONFIG_SCHEMA, CONFIG_SLOTS> configStore(config);
+static_assert(decltype(configStore)::END <= STORAGE_SIZE, "Config slots must fit the EEPROM");
+XBeeAddress64 hubAddress = XBEE_ADDRESS_COORDINATOR;
+bool hubLegacy;
+Forecast forecast;
+Clock clockModel;
+uint32_t clockHigh;
+unsigned long clockLast;
+Channel channels[ZONES];
+Valve valves[ZONES];
+uint8_t valvesStatus;
+unsigned long wateringLast;
+uint8_t channelNext;
+unsigned long sampleLast;
 unsigned long updateLast;
-unsigned long weatherLast;
+unsigned long updateDelay = UPDATE_INTERVAL;
+
+Sample reportLast;
+unsigned long reportTimeLast;
+bool reported;
+uint32_t reportsSent;
+uint32_t reportsSuppressed;
+unsigned long statsLast;
+unsigned long radioLast;
+uint32_t radioFailures;
+bool radioLost;
+DeviceCounters counters;
+bool stateDirty = true;
+uint8_t linkSeen[LINK_DEDUP];
+unsigned long linkSeenAt[LINK_DEDUP];
+uint8_t linkSeenNext;
+unsigned long asleepTotal;
+
+RingBuffer<Sample, SAMPLES_MAX> samples;
+uint16_t sampleSeq;
+uint8_t session;
+unsigned long drainLast;
+unsigned long drainDelay = DRAIN_INTERVAL;
+uint32_t samplesDropped;
 
 /* Настройки */
 
+// Старая раскладка переносится один раз: первое сохранение пишет запись журнала поверх неё.
+// Стёртая память (-1) и запись журнала, прочитанная как старая структура, не проходят проверку диапазона.
+void configImport() {
+    LegacyConfig legacy;
+    configStore.loadLegacy(legacy);
+    if (legacy.reference < 0 || legacy.reference > 100 || legacy.mode < OFF || legacy.mode > AUTO) return;
+
+    for (Zone &zone: config.zones) {
+        zone.reference = legacy.reference;
+        zone.mode = legacy.mode;
+    }
+    configStore.save();
+    LOG_INFO(LOG_CONFIG_IMPORTED);
+}
+
 void loadConfig() {
-    EEPROM.begin();
-    EEPROM.get(0, config);
-    EEPROM.end();
+    if (!configStore.load()) {
+        memset(&config, 0xFF, sizeof(config));
+        configImport();
+    }
+
+    for (Zone &zone: config.zones) {
+        if (zone.reference == -1) zone.reference = MIN_MOIST;
+        if (zone.mode == -1) zone.mode = AUTO;
+        if (zone.dry == -1) zone.dry = 0;
+        if (zone.wet == -1) zone.wet = ADC_MAX;
+    }
+    if (config.lookahead == 0xFF) config.lookahead = RAIN_LOOKAHEAD;
+    if (config.deadband == 0xFF) config.deadband = REPORT_DEADBAND;
+    if (config.heartbeat == 0xFFFF) config.heartbeat = REPORT_HEARTBEAT;
+    if (config.sleep == 0xFF) config.sleep = 0;
+}
+
+void saveConfig() { configStore.save(); }
+
+/* Датчики */
+
+int channelRaw(const uint8_t zone) { return channels[zone].filtered / FILTER_SCALE; }
+
+int channelMoisture(const uint8_t zone) {
+    const Zone &calibration = config.zones[zone];
+    if (calibration.wet == calibration.dry) return 0;
+    const long moisture = (channelRaw(zone) - calibration.dry) * 100l / (calibration.wet - calibration.dry);
+    return static_cast<int>(constrain(moisture, 0l, 100l));
+}
+
+void acquisitionTask() {
+    const unsigned long now = millis();
+    if (now - sampleLast < SAMPLE_INTERVAL) return;
+    sampleLast = now;
+
+    channelSample(channels[channelNext], adcRead(PIN_MOIST[channelNext], OVERSAMPLING));
+    channelNext = (channelNext + 1) % ZONES;
+}
+
+// Во сне фоновый опрос стоит, поэтому перед проверкой окно фильтра заполняется заново.
+void acquisitionBurst() {
+    for (uint8_t i = 0; i < FILTER_WINDOW * ZONES; i++) {
+        channelSample(channels[channelNext], adcRead(PIN_MOIST[channelNext], OVERSAMPLING));
+        channelNext = (channelNext + 1) % ZONES;
+    }
+    sampleLast = millis();
+}
+
+void calibrate(const uint8_t zone, const int16_t dry, const int16_t wet) {
+    Zone &calibration = config.zones[zone];
+    if (dry != CALIBRATION_KEEP) calibration.dry = dry == CALIBRATION_CURRENT ? channelRaw(zone) : dry;
+    if (wet != CALIBRATION_KEEP) calibration.wet = wet == CALIBRATION_CURRENT ? channelRaw(zone) : wet;
+    saveConfig();
+}
+
+/* Время */
+
+// millis() переполняется через 49 дней; старшее слово дописывается здесь, а loop() вызывает функцию чаще.
+uint64_t clockLocal() {
+    const unsigned long now = millis();
+    if (now < clockLast) clockHigh++;
+    clockLast = now;
+    return static_cast<uint64_t>(clockHigh) << 32 | now;
+}
+
+int64_t clockWall(const uint64_t local) {
+    const int64_t elapsed = static_cast<int64_t>(local - clockModel.base);
+    return static_cast<int64_t>(local) + clockModel.offset + elapsed * clockModel.drift / 1000000;
+}
 
-    if (config.reference == -1) config.reference = MIN_MOIST;
-    if (config.mode == -1) config.mode = AUTO;
+// Секунды по часам хаба, если они уже известны, иначе — собственные секунды устройства.
+// Так и замеры, снятые до первой синхронизации, уходят с временем хаба.
+uint32_t clockSeconds(const uint32_t local) {
+    if (!clockModel.synced) return local;
+    return clockWall(local * 1000ull) / 1000;
 }
 
-void saveConfig() {
-    EEPROM.begin();
-    EEPROM.put(0, config);
-    EEPROM.end();
+uint32_t clockNow() { return clockSeconds(clockLocal() / 1000); }
+
+// Смещение и задержка — как в NTP: origin и текущее время по часам устройства, received и sent — по часам хаба.
+// Разница между новым смещением и предсказанным моделью — ошибка часов; накопленная за окно, она уточняет уход.
+void clockSync(const TimeFrame &frame) {
+    const uint64_t now = clockLocal();
+    if (!clockModel.requested || static_cast<uint32_t>(clockModel.requested) != frame.origin) return;
+    const int64_t origin = clockModel.requested;
+    const int64_t received = timestampMillis(frame.received);
+    const int64_t sent = timestampMillis(frame.sent);
+    const int64_t delay = (static_cast<int64_t>(now) - origin) - (sent - received);
+    if (delay < 0 || delay > TIME_DELAY_MAX) return;
+    const int64_t offset = ((received - origin) + (sent - static_cast<int64_t>(now))) / 2;
+    clockModel.requested = 0;
+
+    if (clockModel.synced) {
+        const int64_t error = static_cast<int64_t>(now) + offset - clockWall(now);
+        const uint64_t window = now - clockModel.base;
+        clockModel.error = constrain(error, INT16_MIN, INT16_MAX);
+        if (window >= TIME_DRIFT_WINDOW) {
+            // Половина измеренной поправки: одиночный запрос с нетипичной задержкой не раскачивает модель.
+            const int64_t drift = clockModel.drift + error * 1000000 / static_cast<int64_t>(window) / 2;
+            clockModel.drift = constrain(drift, -TIME_DRIFT_MAX, TIME_DRIFT_MAX);
+        }
+    }
+    clockModel.synced = true;
+    clockModel.base = now;
+    clockModel.offset = offset;
+    clockModel.delay = delay;
+}
+
+/* Прогноз */
+
+void forecastReceive(const ForecastFrame &frame) {
+    forecast.valid = true;
+    forecast.time = frame.time;
+    forecast.now = frame.now;
+    forecast.received = millis();
+    memcpy(forecast.rain, frame.rain, sizeof(forecast.rain));
+}
+
+// Старый хаб шлёт только признак дождя: прогноз начинается сейчас в той же шкале, что берёт rainExpected().
+void forecastLegacy(const bool rain) {
+    forecast.valid = rain;
+    forecast.now = clockModel.synced ? clockNow() : 0;
+    forecast.time = forecast.now;
+    forecast.received = millis();
+    memset(forecast.rain, MIN_RAIN, sizeof(forecast.rain));
+}
+
+bool rainExpected(const uint8_t lookahead) {
+    if (!forecast.valid) return false;
+
+    const uint32_t now = clockModel.synced ? clockNow() : forecast.now + (millis() - forecast.received) / 1000;
+    if (now < forecast.time) return false;
+
+    const uint32_t hour = (now - forecast.time) / 3600;
+    unsigned int rain = 0;
+    for (uint32_t i = hour; i < hour + lookahead && i < FORECAST_HOURS; i++) rain += forecast.rain[i];
+    return rain >= MIN_RAIN;
+}
+
+/* Телеметрия */
+
+void samplesAck(const uint16_t first, const uint16_t last) {
+    bool acked = false;
+    while (!samples.empty()) {
+        const uint16_t seq = samples.front().seq;
+        if (seqBefore(seq, first) || seqBefore(last, seq)) break;
+        samples.pop();
+        acked = true;
+    }
+    if (!acked) return;
+
+    drainDelay = DRAIN_INTERVAL;
+    drainLast = millis() - DRAIN_INTERVAL;
+}
+
+void zbSend(const void *data, uint8_t length);
+
+void drainTask() {
+    if (hubLegacy || samples.empty()) return;
+    if (millis() - drainLast < drainDelay) return;
+
+    TelemetryFrame frame = frameOf<TelemetryFrame>(MESSAGE_TELEMETRY);
+    frame.session = session;
+    frame.now = clockNow();
+    frame.zones = ZONES;
+    frame.count = min(samples.size(), static_cast<size_t>(TELEMETRY_BATCH));
+    for (uint8_t i = 0; i < frame.count; i++) {
+        frame.samples[i] = samples[i];
+        frame.samples[i].time = clockSeconds(samples[i].time);
+    }
+    // Счётчики — на момент перед отправкой этого пакета; самая долгая итерация считается заново до следующего.
+    frame.counters = counters;
+    counters.loopMax = 0;
+    zbSend(&frame, telemetryFrameSize(frame.count));
+
+    drainLast = millis();
+    drainDelay = min(drainDelay * 2, DRAIN_INTERVAL_MAX);
+}
+
+void statsTask() {
+    if (hubLegacy || millis() - statsLast < STATS_INTERVAL) return;
+    statsLast = millis();
+
+    const uint32_t asleep = asleepTotal / 1000;
+    const uint32_t awake = clockLocal() / 1000 - asleep;
+    const StatsFrame frame = {
+        frameHeaderOf(MESSAGE_STATS), reportsSent, reportsSuppressed, samplesDropped, awake, asleep, configStore.writes(),
+        radioFailures, logWritten(), logDropped(),
+    };
+    zbSend(&frame, sizeof(frame));
 }
 
 /* ZigBee */
 
-void zbReceive(ZBRxResponse &rx, uintptr_t) {
-    const int payloadLength = rx.getDataLength();
-    char payload[payloadLength + 1];
+Mode modeFrom(const char *value) { return strcmp(value, MODE_OFF) == 0 ? OFF : strcmp(value, MODE_ON) == 0 ? ON : AUTO; }
+
+Mode modeFrom(const int16_t value) { return value == atoi(MODE_OFF) ? OFF : value == atoi(MODE_ON) ? ON : AUTO; }
+
+int16_t modeValue(const Mode mode) { return atoi(mode == OFF ? MODE_OFF : mode == ON ? MODE_ON : MODE_AUTO); }
+
+void zbReceiveLegacy(ZBRxResponse &rx) {
+    const uint8_t payloadLength = rx.getDataLength();
+    if (payloadLength > PROTOCOL_PAYLOAD_MAX) {
+        counters.framesInvalid++;
+        return;
+    }
+    char payload[PROTOCOL_PAYLOAD_MAX + 1];
     memcpy(payload, rx.getData(), payloadLength);
     payload[payloadLength] = '\0';
 
-    Serial.print("ZigBee payload received: ");
-    Serial.println(payload);
-
     const char *command = strtok(payload, "=");
     const char *value = strtok(nullptr, "=");
+    if (!command || !value) {
+        counters.framesInvalid++;
+        return;
+    }
+
+    const Signal signal = signalByLegacy(command);
+    LOG_DEBUG(LOG_ZB_LEGACY, hubAddress.getLsb(), signal, atoi(value));
+    switch (signal) {
+        case SIGNAL_REFERENCE:
+            for (Zone &zone: config.zones) zone.reference = atoi(value);
+            saveConfig();
+            break;
+        case SIGNAL_MODE:
+            for (Zone &zone: config.zones) zone.mode = modeFrom(value);
+            saveConfig();
+            break;
+        case SIGNAL_RAIN:
+            forecastLegacy(strcmp(value, "1") == 0);
+            break;
+        default:
+            break;
+    }
+}
 
-    if (strcmp(command, XBEE_COMMAND_REFERENCE) == 0) {
-        config.reference = static_cast<int>(String(value).toInt());
-        saveConfig();
-    } else if (strcmp(command, XBEE_COMMAND_MODE) == 0) {
-        config.mode = strcmp(value, MODE_OFF) == 0 ? OFF : strcmp(value, MODE_ON) == 0 ? ON : AUTO;
-        saveConfig();
-    } else if (strcmp(command, XBEE_COMMAND_RAIN) == 0) {
-        rainSoon = strcmp(value, "1") == 0;
+// Изменённые настройки сохраняются и попадают в следующий отчёт хабу.
+void commandApply(const MessageType type, const uint8_t zone, const int16_t value) {
+    switch (type) {
+        case MESSAGE_REFERENCE:
+            if (zone >= ZONES) return;
+            config.zones[zone].reference = value;
+            break;
+        case MESSAGE_MODE:
+            if (zone >= ZONES) return;
+            config.zones[zone].mode = modeFrom(value);
+            break;
+        case MESSAGE_RAIN:
+            forecastLegacy(value != 0);
+            return;
+        case MESSAGE_LOOKAHEAD:
+            config.lookahead = constrain(value, 1, FORECAST_HOURS);
+            break;
+        case MESSAGE_DEADBAND:
+            config.deadband = constrain(value, 0, 100);
+            break;
+        case MESSAGE_HEARTBEAT:
+            config.heartbeat = max(value, static_cast<int16_t>(1));
+            break;
+        case MESSAGE_SLEEP:
+            config.sleep = value != 0;
+            break;
+        default:
+            return;
     }
+    saveConfig();
+    stateDirty = true;
 }
 
-void zbSend(const char *command, const char *value) {
-    const auto commandLength = strlen(command);
-    const auto valueLength = strlen(value);
-    const auto payloadLength = commandLength + valueLength + 1;
+int16_t settingValue(const Signal signal, const uint8_t zone) {
+    switch (signal) {
+        case SIGNAL_REFERENCE:
+            return config.zones[zone].reference;
+        case SIGNAL_MODE:
+            return modeValue(config.zones[zone].mode);
+        case SIGNAL_LOOKAHEAD:
+            return config.lookahead;
+        case SIGNAL_DEADBAND:
+            return config.deadband;
+        case SIGNAL_HEARTBEAT:
+            return config.heartbeat;
+        case SIGNAL_SLEEP:
+            return config.sleep;
+        default:
+            return 0;
+    }
+}
 
-    char buffer[payloadLength];
-    sprintf(buffer, "%s=%s", command, value);
-    const auto payload = reinterpret_cast<unsigned char *>(buffer);
+// Хаб присылает только расходящиеся значения; отчёт уходит в ответ всегда, даже на пустой запрос.
+void stateReceive(const StateFrame &frame, const uint8_t length) {
+    const uint8_t count = min(stateFrameCount(length), STATE_ENTRIES_MAX);
+    for (uint8_t i = 0; i < count; i++) {
+        const StateEntry &entry = frame.entries[i];
+        if (entry.signal >= SIGNAL_COUNT || !signalIsState(entry.signal)) {
+            counters.framesInvalid++;
+            continue;
+        }
+        commandApply(SIGNALS[entry.signal].type, entry.zone, entry.value);
+    }
+    stateDirty = true;
+}
 
-    constexpr XBeeAddress64 address(0x00000000, 0x0000FFFF);
-    ZBTxRequest tx(address, payload, payloadLength);
+// До первой синхронизации запросы чаще: без часов хаба замеры копятся с временем устройства.
+void timeTask() {
+    if (hubLegacy) return;
+    const uint64_t now = clockLocal();
+    const uint64_t last = clockModel.requested ? clockModel.requested : clockModel.base;
+    if (last != 0 && now - last < (clockModel.synced ? TIME_SYNC_INTERVAL : TIME_SYNC_RETRY)) return;
+
+    TimeFrame frame = frameOf<TimeFrame>(MESSAGE_TIME);
+    frame.origin = static_cast<uint32_t>(now);
+    frame.delay = clockModel.synced ? clockModel.delay : 0xFFFF;
+    frame.error = clockModel.error;
+    frame.drift = clockModel.drift;
+    clockModel.requested = now;
+    zbSend(&frame, sizeof(frame));
+}
+
+void stateTask() {
+    if (hubLegacy || !stateDirty) return;
+    stateDirty = false;
+
+    StateFrame frame = frameOf<StateFrame>(MESSAGE_STATE);
+    uint8_t count = 0;
+    for (const Signal signal: STATE_SIGNALS) {
+        const uint8_t zones = SIGNALS[signal].zoned ? ZONES : 1;
+        for (uint8_t zone = 0; zone < zones; zone++) {
+            frame.entries[count++] = {signal, zone, settingValue(signal, zone)};
+        }
+    }
+    zbSend(&frame, stateFrameSize(count));
+}
+
+// Повтор команды, ответ на которую потерялся, подтверждается ещё раз, но не применяется.
+bool linkDuplicate(const uint8_t seq) {
+    for (uint8_t i = 0; i < LINK_DEDUP; i++) {
+        if (linkSeen[i] == seq && millis() - linkSeenAt[i] < LINK_DEDUP_TIME) return true;
+    }
+    linkSeen[linkSeenNext] = seq;
+    linkSeenAt[linkSeenNext] = millis();
+    linkSeenNext = (linkSeenNext + 1) % LINK_DEDUP;
+    return false;
+}
+
+void zbReceiveFrame(const uint8_t *data, const uint8_t length) {
+    const FrameHeader *header = frameHeader(data, length);
+    if (!header) {
+        LOG_WARN(LOG_ZB_UNSUPPORTED);
+        counters.framesInvalid++;
+        return;
+    }
+    LOG_DEBUG(LOG_ZB_FRAME, header->type, header->seq);
+
+    if (header->seq != 0) {
+        const LinkAckFrame ack = {frameHeaderOf(MESSAGE_LINK_ACK), header->seq};
+        zbSend(&ack, sizeof(ack));
+        if (linkDuplicate(header->seq)) return;
+    }
+
+    if (header->type == MESSAGE_FORECAST) {
+        const ForecastFrame *frame = frameAs<ForecastFrame>(data, length);
+        if (!frame) counters.framesInvalid++;
+        if (frame) forecastReceive(*frame);
+        return;
+    }
+    if (header->type == MESSAGE_ACK) {
+        const AckFrame *frame = frameAs<AckFrame>(data, length);
+        if (!frame) counters.framesInvalid++;
+        if (frame) samplesAck(frame->first, frame->last);
+        return;
+    }
+    if (header->type == MESSAGE_CALIBRATION) {
+        const CalibrationFrame *frame = frameAs<CalibrationFrame>(data, length);
+        if (!frame) counters.framesInvalid++;
+        if (frame && frame->zone < ZONES) calibrate(frame->zone, frame->dry, frame->wet);
+        return;
+    }
+
+    if (header->type == MESSAGE_STATE) {
+        const bool valid = length >= stateFrameSize(0);
+        if (!valid) counters.framesInvalid++;
+        if (valid) stateReceive(*reinterpret_cast<const StateFrame *>(data), length);
+        return;
+    }
+    if (header->type == MESSAGE_TIME) {
+        const TimeFrame *frame = frameAs<TimeFrame>(data, length);
+        if (!frame) counters.framesInvalid++;
+        if (frame) clockSync(*frame);
+        return;
+    }
+
+    const CommandFrame *frame = frameAs<CommandFrame>(data, length);
+    if (!frame) {
+        counters.framesInvalid++;
+        return;
+    }
+    commandApply(header->type, frame->zone, frame->value);
+}
+
+void zbReceive(ZBRxResponse &rx, uintptr_t) {
+    hubAddress = rx.getRemoteAddress64();
+    radioLast = millis();
+    counters.framesIn++;
+
+    const uint8_t *data = rx.getData();
+    const uint8_t length = rx.getDataLength();
+    hubLegacy = !frameIsCompatible(data, length);
+    if (hubLegacy && frameIsBinary(data, length)) {
+        LOG_WARN(LOG_ZB_VERSION, length >= 2 ? data[1] : 0);
+        counters.framesInvalid++;
+        return;
+    }
+    hubLegacy ? zbReceiveLegacy(rx) : zbReceiveFrame(data, length);
+}
+
+// Первая доставка после отказов значит, что хаб снова на связи и мог пропустить изменения настроек.
+void zbTxStatus(ZBTxStatusResponse &status, uintptr_t) {
+    if (!status.isSuccess()) {
+        radioFailures++;
+        radioLost = true;
+        return;
+    }
+    if (radioLost) stateDirty = true;
+    radioLost = false;
+}
+
+void zbSend(const void *data, const uint8_t length) {
+    const auto payload = static_cast<uint8_t *>(const_cast<void *>(data));
+    ZBTxRequest tx(hubAddress, payload, length);
     xbeeClient.send(tx);
+    radioLast = millis();
+    counters.framesOut++;
+}
+
+void zbSendLegacy(const char *command, const int value) {
+    char buffer[PROTOCOL_PAYLOAD_MAX + 1];
+    const int payloadLength = snprintf(buffer, sizeof(buffer), "%s=%d", command, value);
+    if (payloadLength < 0 || payloadLength > PROTOCOL_PAYLOAD_MAX) return;
+    zbSend(buffer, static_cast<uint8_t>(payloadLength));
 }
 
 /* Растения */
 
-bool shouldWater(const float moisture, const float water, const bool rainSoon, const Mode mode) {
+bool shouldWater(const float moisture, const float water, const bool rainSoon, const Zone &zone, const bool open) {
     if (water == LOW) return false;
 
-    if (mode == OFF) return false;
-    if (mode == ON) return true;
+    if (zone.mode == OFF) return false;
+    if (zone.mode == ON) return true;
 
     if (moisture < MIN_MOIST) return true;
     if (rainSoon) return false;
-    return moisture < config.reference;
+    return moisture < zone.reference + (open ? WATERING_HYSTERESIS : 0);
 }
 
-void checkPlants() {
-    int moisture = 0;
-    for (const int i: PIN_MOIST) moisture += static_cast<int>(map(analogRead(i), 0, 1023, 0, 100));
-    moisture /= sizeof(PIN_MOIST);
-    zbSend(XBEE_COMMAND_VALUE, String(moisture).c_str());
+// В автоматическом режиме полив ограничен по длительности, а между поливами выдерживается пауза.
+bool zoneWater(const uint8_t zone, const int moisture, const bool water, const bool rainSoon) {
+    const Valve &valve = valves[zone];
+    const Zone &settings = config.zones[zone];
+    const unsigned long now = millis();
+
+    if (settings.mode == AUTO) {
+        if (valve.open && now - valve.opened >= WATERING_RUN_MAX) return false;
+        if (!valve.open && valve.closed != 0 && now - valve.closed < WATERING_OFF_MIN) return false;
+    }
+    return shouldWater(moisture, water, rainSoon, settings, valve.open);
+}
+
+void wateringReport(const uint8_t zone, const unsigned long duration) {
+    if (hubLegacy) return;
+
+    const WateringFrame frame = {frameHeaderOf(MESSAGE_WATERING), zone, static_cast<uint16_t>(min(duration / 1000, 0xFFFFul)),
+                                 static_cast<uint32_t>(static_cast<uint64_t>(duration) * WATERING_FLOW / 60000),
+                                 clockModel.synced ? clockNow() : 0};
+    zbSend(&frame, sizeof(frame));
+}
+
+void valveSet(const uint8_t zone, const bool open) {
+    Valve &valve = valves[zone];
+    if (valve.open == open) return;
+
+    valve.open = open;
+    digitalWrite(PIN_VALVE[zone], open);
+    if (open) {
+        valve.opened = millis();
+        return;
+    }
+    valve.closed = millis();
+    wateringReport(zone, valve.closed - valve.opened);
+}
+
+void valvesUpdate(const uint8_t *moisture, const bool water) {
+    const bool rainSoon = rainExpected(config.lookahead);
+
+    valvesStatus = 0;
+    for (uint8_t i = 0; i < ZONES; i++) {
+        valveSet(i, zoneWater(i, moisture[i], water, rainSoon));
+        if (valves[i].open) valvesStatus |= 1 << i;
+    }
+    digitalWrite(PIN_WATERING, valvesStatus != 0);
+}
+
+bool sampleChanged(const Sample &sample) {
+    if (!reported) return true;
+    if (sample.water != reportLast.water || sample.status != reportLast.status) return true;
+    for (uint8_t i = 0; i < ZONES; i++) {
+        if (abs(sample.moisture[i] - reportLast.moisture[i]) > config.deadband) return true;
+    }
+    return false;
+}
 
+// Чем ближе влажность зон в автоматическом режиме к уставке, тем чаще проверка.
+unsigned long updateIntervalFor(const Sample &sample, const bool changed) {
+    if (changed) return UPDATE_INTERVAL_MIN;
+
+    int margin = UPDATE_MARGIN;
+    for (uint8_t i = 0; i < ZONES; i++) {
+        if (config.zones[i].mode == AUTO) margin = min(margin, sample.moisture[i] - config.zones[i].reference);
+    }
+    if (margin <= 0) return UPDATE_INTERVAL_MIN;
+    return UPDATE_INTERVAL_MIN + (UPDATE_INTERVAL_MAX - UPDATE_INTERVAL_MIN) * margin / UPDATE_MARGIN;
+}
+
+void checkPlants() {
     const bool water = digitalRead(PIN_WATER) == LOW;
-    zbSend(XBEE_COMMAND_WATER, String(water).c_str());
 
-    const bool should = shouldWater(moisture, water, rainSoon, config.mode);
-    zbSend(XBEE_COMMAND_STATUS, should ? "1" : "0");
-    digitalWrite(PIN_WATERING, should);
+    Sample sample = {sampleSeq, static_cast<uint32_t>(clockLocal() / 1000), water, 0, {}};
+
+    int moistureTotal = 0;
+    for (uint8_t i = 0; i < ZONES; i++) {
+        sample.moisture[i] = channelMoisture(i);
+        moistureTotal += sample.moisture[i];
+    }
+    valvesUpdate(sample.moisture, water);
+    sample.status = valvesStatus;
+
+    const bool changed = sampleChanged(sample);
+    updateDelay = updateIntervalFor(sample, changed);
+    if (!changed && millis() - reportTimeLast < config.heartbeat * 60000ul) {
+        reportsSuppressed++;
+        return;
+    }
+
+    reportsSent++;
+    reported = true;
+    reportLast = sample;
+    reportTimeLast = millis();
+
+    if (hubLegacy) {
+        zbSendLegacy(SIGNALS[SIGNAL_VALUE].legacy, moistureTotal / ZONES);
+        zbSendLegacy(SIGNALS[SIGNAL_WATER].legacy, water);
+        zbSendLegacy(SIGNALS[SIGNAL_STATUS].legacy, sample.status != 0);
+        return;
+    }
+
+    sampleSeq++;
+    if (!samples.push(sample)) samplesDropped++;
+    drainLast = millis() - drainDelay;
+}
+
+// Пока открыт хотя бы один клапан, влажность проверяется каждую секунду.
+void wateringTask() {
+    if (valvesStatus == 0 || millis() - wateringLast < WATERING_INTERVAL) return;
+    wateringLast = millis();
+
+    uint8_t moisture[ZONES];
+    for (uint8_t i = 0; i < ZONES; i++) moisture[i] = channelMoisture(i);
+
+    const uint8_t status = valvesStatus;
+    valvesUpdate(moisture, digitalRead(PIN_WATER) == LOW);
+    if (valvesStatus == status) return;
+
+    checkPlants();
+    updateLast = millis();
+}
+
+/* Питание */
+
+unsigned long remaining(const unsigned long last, const unsigned long interval) {
+    const unsigned long elapsed = millis() - last;
+    return elapsed >= interval ? 0 : interval - elapsed;
+}
+
+unsigned long sleepDeadline() {
+    unsigned long deadline = min(remaining(updateLast, updateDelay), remaining(statsLast, STATS_INTERVAL));
+    if (!hubLegacy && !samples.empty()) deadline = min(deadline, remaining(drainLast, drainDelay));
+    return deadline;
+}
+
+// Пока идёт полив или ждётся ответ хаба, устройство не спит: насос потребляет больше, чем МК и радио.
+void sleepTask() {
+    if (!config.sleep || valvesStatus != 0) return;
+    if (millis() - radioLast < RADIO_AWAKE_WINDOW) return;
+
+    const unsigned long deadline = sleepDeadline();
+    if (deadline < SLEEP_MIN) return;
+
+    configStore.flush();
+    // В stop-режиме UART останавливается: начатая запись журнала дописывается до сна, иначе декодер её потеряет.
+    Serial.flush();
+
+    digitalWrite(PIN_XBEE_SLEEP, HIGH);
+    asleepTotal += sleepFor(deadline);
+    digitalWrite(PIN_XBEE_SLEEP, LOW);
+    delay(XBEE_WAKE_TIME);
 }
 
 /* База */
 
 void setup() {
-    Serial.begin(9600);
-    Serial2.begin(9600);
+    Serial.begin(LOG_BAUD);
+    radioSerial().begin(9600);
 
     loadConfig();
 
+    randomSeed(analogRead(PIN_MOIST[0]) ^ micros());
+    session = random(256);
+
     pinMode(PIN_WATER, INPUT_PULLUP);
     pinMode(PIN_WATERING, OUTPUT);
+    pinMode(PIN_XBEE_SLEEP, OUTPUT);
+    digitalWrite(PIN_XBEE_SLEEP, LOW);
+    for (const int pin: PIN_VALVE) pinMode(pin, OUTPUT);
 
-    xbeeClient.setSerial(Serial2);
+    xbeeClient.setSerial(radioSerial());
     xbeeClient.onZBRxResponse(zbReceive);
+    xbeeClient.onZBTxStatusResponse(zbTxStatus);
+
+    sleepBegin();
 }
 
+#ifdef HEAP_AUDIT
+bool loopWarm;
+#endif
+
 void loop() {
+#ifdef HEAP_AUDIT
+    const unsigned long allocations = heapAllocations();
+#endif
+    const unsigned long started = millis();
     xbeeClient.loop();
+    acquisitionTask();
+    wateringTask();
+    drainTask();
+    statsTask();
+    stateTask();
+    timeTask();
+    configStore.task(CONFIG_COMMIT_DELAY);
 
-    const unsigned long now = millis();
-    if (now < updateLast || now - updateLast > UPDATE_INTERVAL) {
+    if (millis() - updateLast > updateDelay) {
+        if (config.sleep) acquisitionBurst();
         checkPlants();
         updateLast = millis();
     }
-    if (now < weatherLast || now - weatherLast > WEATHER_INTERVAL) {
-        rainSoon = false;
-        weatherLast = millis();
-    }
+
+    logDrain(Serial);
+    const unsigned long elapsed = min(millis() - started, 0xFFFFul);
+    if (elapsed > counters.loopMax) counters.loopMax = elapsed;
+    sleepTask();
+#ifdef HEAP_AUDIT
+    if (loopWarm) heapAuditCheck("loop", allocations);
+    loopWarm = true;
+#endif
 }
@@ -0,0 +1,65 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <ArduinoJson.h>
+#include <stddef.h>
+
+/*
+ * Память для JsonDocument из статического буфера вместо кучи.
+ * Блоки выдаются подряд и освобождаются все разом в reset(), так что регулярные запросы
+ * не дробят кучу, а документ больше N байт получает NoMemory, а не съедает её.
+ */
+
+template<size_t N>
+class Arena : public ArduinoJson::Allocator {
+public:
+    void *allocate(const size_t size) override {
+        const size_t total = align(sizeof(size_t) + size);
+        if (total > N - used) return nullptr;
+
+        // Размер блока хранится перед ним: он нужен reallocate(), чтобы скопировать содержимое.
+        auto *block = reinterpret_cast<size_t *>(buffer + used);
+        *block = size;
+        used += total;
+        if (used > high) high = used;
+        return block + 1;
+    }
+
+    void deallocate(void *) override {}
+
+    void *reallocate(void *pointer, const size_t size) override {
+        if (!pointer) return allocate(size);
+        auto *block = static_cast<size_t *>(pointer) - 1;
+        const size_t start = reinterpret_cast<uint8_t *>(block) - buffer;
+
+        // Последний блок растёт и сжимается на месте: так ArduinoJson обычно меняет пул или строку.
+        if (start + align(sizeof(size_t) + *block) == used) {
+            const size_t total = align(sizeof(size_t) + size);
+            if (total > N - start) return nullptr;
+            *block = size;
+            used = start + total;
+            if (used > high) high = used;
+            return pointer;
+        }
+
+        void *moved = allocate(size);
+        if (moved) memcpy(moved, pointer, min(*block, size));
+        return moved;
+    }
+
+    // После сброса ни один документ из арены больше не используется.
+    void reset() { used = 0; }
+
+    size_t highWater() const { return high; }
+
+private:
+    alignas(max_align_t) uint8_t buffer[N];
+    size_t used = 0;
+    size_t high = 0;
+
+    static constexpr size_t align(const size_t size) {
+        return (size + alignof(max_align_t) - 1) & ~(alignof(max_align_t) - 1);
+    }
+};
+
+#endif
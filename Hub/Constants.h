@@ -9,24 +9,109 @@
 constexpr char WIFI_SSID[] = "ESP32 Config";
 constexpr char WIFI_PASSWORD[] = "";
 
-constexpr char MQTT_TOPIC_REFERENCE[] = "moisture/reference";
-constexpr char MQTT_TOPIC_VALUE[] = "moisture/value";
-constexpr char MQTT_TOPIC_MODE[] = "watering/mode";
-constexpr char MQTT_TOPIC_STATUS[] = "watering/status";
-constexpr char MQTT_TOPIC_WATER[] = "water/level";
-
-constexpr char XBEE_COMMAND_REFERENCE[] = "REFERENCE";
-constexpr char XBEE_COMMAND_VALUE[] = "VALUE";
-constexpr char XBEE_COMMAND_MODE[] = "MODE";
-constexpr char XBEE_COMMAND_STATUS[] = "STATUS";
-constexpr char XBEE_COMMAND_WATER[] = "WATER";
-constexpr char XBEE_COMMAND_RAIN[] = "RAIN";
+constexpr char MQTT_TOPIC_HISTORY[] = "telemetry/history";
+constexpr char MQTT_TOPIC_WATERING_DURATION[] = "watering/duration";
+constexpr char MQTT_TOPIC_WATERING_VOLUME[] = "watering/volume";
+constexpr char MQTT_TOPIC_WATERING_TIME[] = "watering/time";
+constexpr char MQTT_TOPIC_AWAKE[] = "stats/power/awake";
+constexpr char MQTT_TOPIC_ASLEEP[] = "stats/power/asleep";
+constexpr char MQTT_TOPIC_REPORTS_SENT[] = "stats/reports/sent";
+constexpr char MQTT_TOPIC_REPORTS_SUPPRESSED[] = "stats/reports/suppressed";
+constexpr char MQTT_TOPIC_SAMPLES_DROPPED[] = "stats/samples/dropped";
+constexpr char MQTT_TOPIC_CONFIG_WRITES[] = "stats/config/writes";
+constexpr char MQTT_TOPIC_RADIO_FAILURES[] = "stats/link/uplink_failed";
+constexpr char MQTT_TOPIC_LINK_DELIVERED[] = "stats/link/delivered";
+constexpr char MQTT_TOPIC_LINK_RETRIES[] = "stats/link/retries";
+constexpr char MQTT_TOPIC_LINK_FAILED[] = "stats/link/failed";
+constexpr char MQTT_TOPIC_LINK_TX_FAILED[] = "stats/link/tx_failed";
+constexpr char MQTT_TOPIC_LINK_LATENCY[] = "stats/link/latency";
+constexpr char MQTT_TOPIC_LINK_LATENCY_MAX[] = "stats/link/latency_max";
+constexpr char MQTT_TOPIC_TIME_DELAY[] = "stats/time/delay";
+constexpr char MQTT_TOPIC_TIME_ERROR[] = "stats/time/error";
+constexpr char MQTT_TOPIC_TIME_DRIFT[] = "stats/time/drift";
+constexpr char MQTT_TOPIC_QUEUE_DEPTH[] = "stats/mqtt/queue";
+constexpr char MQTT_TOPIC_QUEUE_DROPPED[] = "stats/mqtt/dropped";
+constexpr char MQTT_TOPIC_RECONNECTS[] = "stats/mqtt/reconnects";
+constexpr char MQTT_TOPIC_HTTPS_REQUESTS[] = "stats/https/requests";
+constexpr char MQTT_TOPIC_HTTPS_HANDSHAKES[] = "stats/https/handshakes";
+constexpr char MQTT_TOPIC_CPU_RADIO[] = "stats/cpu/radio";
+constexpr char MQTT_TOPIC_CPU_NETWORK[] = "stats/cpu/network";
+constexpr char MQTT_TOPIC_RADIO_STACK[] = "stats/radio/stack_free";
+constexpr char MQTT_TOPIC_UPLINK_HIGH[] = "stats/uplink/high_water";
+constexpr char MQTT_TOPIC_UPLINK_DROPPED[] = "stats/uplink/dropped";
+constexpr char MQTT_TOPIC_DOWNLINK_HIGH[] = "stats/downlink/high_water";
+constexpr char MQTT_TOPIC_DOWNLINK_DROPPED[] = "stats/downlink/dropped";
+constexpr char MQTT_TOPIC_LOG_WRITTEN[] = "stats/log/written";
+constexpr char MQTT_TOPIC_LOG_DROPPED[] = "stats/log/dropped";
+constexpr char MQTT_TOPIC_LOG_BYTES[] = "stats/log/bytes";
+constexpr char MQTT_TOPIC_FRAMES_IN[] = "stats/frames/in";
+constexpr char MQTT_TOPIC_FRAMES_OUT[] = "stats/frames/out";
+constexpr char MQTT_TOPIC_FRAMES_INVALID[] = "stats/frames/invalid";
+constexpr char MQTT_TOPIC_LOOP_MAX[] = "stats/loop/max";
+constexpr char MQTT_TOPIC_DIAGNOSTICS[] = "diagnostics";
+constexpr char MQTT_TOPIC_BOOT_REASON[] = "stats/boot/reason";
+constexpr char MQTT_TOPIC_BOOT_FAST[] = "stats/boot/fast";
+constexpr char MQTT_TOPIC_BOOT_RADIO[] = "stats/boot/radio";
+constexpr char MQTT_TOPIC_BOOT_WIFI[] = "stats/boot/wifi";
+constexpr char MQTT_TOPIC_BOOT_MQTT[] = "stats/boot/mqtt";
+constexpr char MQTT_TOPIC_STATE[] = "/state";
+constexpr char MQTT_TOPIC_HUB[] = "hub/%s";
+constexpr char MQTT_TOPIC_NODE[] = "%08lX/%s";
+constexpr char MQTT_TOPIC_NODE_ANY[] = "+/%s";
+constexpr char MQTT_TOPIC_ZONE[] = "%08lX/%u/%s";
+constexpr char MQTT_TOPIC_ZONE_ANY[] = "+/+/%s";
 
 constexpr char ENDPOINT_DEVICE_CONNECT[] = "https://dash.wqtt.ru/api/broker";
 constexpr char ENDPOINT_DEVICE_REGISTER[] = "https://dash.wqtt.ru/api/devices";
 
-constexpr char ENDPOINT_WEATHER[] = "https://api.open-meteo.com/v1/forecast?latitude=%lat%&longitude=%lon%&hourly=rain&forecast_days=1";
-constexpr char ENDPOINT_TIME[] = "https://aisenseapi.com/services/v1/timestamp";
+constexpr char ENDPOINT_WEATHER[] = "https://api.open-meteo.com/v1/forecast?latitude=%.2f&longitude=%.2f&hourly=rain&current=rain&forecast_hours=24&timeformat=unixtime";
+constexpr char TIME_SERVER_PRIMARY[] = "pool.ntp.org";
+constexpr char TIME_SERVER_SECONDARY[] = "time.google.com";
 
-constexpr long EEPROM_SIZE = sizeof(Config);
+constexpr uint8_t CONFIG_SCHEMA = 1;
+constexpr size_t CONFIG_SLOTS = 4;
+constexpr long CONFIG_COMMIT_DELAY = 1000l * 5l;
+constexpr uint8_t NETWORK_SCHEMA = 2;
+constexpr size_t NETWORK_SLOTS = 4;
+constexpr uint8_t SHADOW_SCHEMA = 1;
+constexpr size_t SHADOW_SLOTS = 2;
 constexpr long WEATHER_INTERVAL = 1000l * 60l * 60l;
+constexpr long WEATHER_RETRY_INTERVAL = 1000l * 60l * 10l;
+constexpr time_t CLOCK_VALID_AFTER = TIME_EPOCH_MIN;
+constexpr long REGISTER_INTERVAL = 1000l * 60l;
+constexpr long RECONNECT_INTERVAL = 1000l * 60l;
+constexpr long STATS_INTERVAL = 1000l * 60l * 10l;
+constexpr long DIAGNOSTICS_INTERVAL = 1000l * 60l;
+constexpr long STATE_REQUEST_INTERVAL = 1000l * 60l;
+
+constexpr long WIFI_TIMEOUT = 1000l * 10l;
+constexpr long WIFI_FAST_TIMEOUT = 1000l * 3l;
+// Без сканирования, но с DHCP: ответ сервера адресов добавляет секунду-другую.
+constexpr long WIFI_FAST_DHCP_TIMEOUT = 1000l * 5l;
+// Срок аренды DHCP хабу неизвестен; роутеры выдают адрес на часы и сутки, час заведомо короче.
+constexpr long WIFI_LEASE_TIME = 1000l * 60l * 60l;
+constexpr long MQTT_RETRY_INTERVAL = 1000l;
+constexpr long MQTT_BACKOFF_MAX = 1000l * 60l * 2l;
+constexpr unsigned int MQTT_ATTEMPTS = 10;
+constexpr unsigned int MQTT_PUBLISH_BATCH = 8;
+constexpr uint8_t MQTT_SUBSCRIBE_QOS = 1;
+// Снимок диагностики уходит одним сообщением, минуя очередь, и должен помещаться в буфер клиента.
+constexpr uint16_t MQTT_BUFFER_SIZE = 1024;
+constexpr size_t METRICS_BUFFER_SIZE = 768;
+constexpr uint16_t HTTP_TIMEOUT = 3000;
+// Ожидание ответов брокера, в том числе CONNACK при подключении; PubSubClient принимает его в секундах.
+constexpr uint16_t MQTT_TIMEOUT = 3000;
+// Тело регистрации узла растёт на ~400 байт с каждой зоной; 4 КиБ хватает на ZONES_MAX с запасом.
+constexpr size_t HTTP_BODY_MAX = 4096;
+constexpr size_t JSON_ARENA_SIZE = 1024 * 8;
+constexpr size_t MQTT_PAYLOAD_MAX = 32;
+constexpr long RESTART_DELAY = 1000l * 3l;
+constexpr unsigned int RADIO_FRAMES_PER_TICK = 8;
+// loop() с MQTT, HTTPS и веб-сервером работает на ядре 1, радиомост — отдельной задачей на ядре 0.
+constexpr int RADIO_CORE = 0;
+constexpr unsigned int RADIO_PRIORITY = 2;
+constexpr uint32_t RADIO_STACK = 4096;
+constexpr long LINK_TIMEOUT = 1500l;
+constexpr uint8_t LINK_RETRIES = 3;
+// Спящий узел слушает эфир RADIO_AWAKE_WINDOW после своего кадра (Device/Constants.h): пауза дольше — новое пробуждение.
+constexpr long LINK_AWAKE_WINDOW = 500l;
@@ -0,0 +1,37 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Гистограмма с фиксированными границами корзин: запись — проход по N границам, памяти — N + 1 счётчик.
+ * Значение попадает в первую корзину, граница которой не меньше его, а больше последней — в корзину переполнения.
+ */
+
+template<size_t N>
+class Histogram {
+public:
+    explicit constexpr Histogram(const uint32_t (&bounds)[N]) : bounds(bounds) {}
+
+    void record(const uint32_t value) {
+        size_t bucket = 0;
+        while (bucket < N && value > bounds[bucket]) bucket++;
+        counts[bucket]++;
+        samples++;
+        if (value > high) high = value;
+    }
+
+    static constexpr size_t buckets() { return N + 1; }
+    uint32_t count(const size_t bucket) const { return counts[bucket]; }
+    uint32_t total() const { return samples; }
+    uint32_t maximum() const { return high; }
+
+private:
+    const uint32_t (&bounds)[N];
+    uint32_t counts[N + 1] = {};
+    uint32_t samples = 0;
+    uint32_t high = 0;
+};
+
+#endif
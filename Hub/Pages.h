@@ -2,55 +2,54 @@
 #define PAGES_H
 #endif
 
-constexpr char HTML_PAGE_INDEX[] PROGMEM = R"rawliteral(
-<!DOCTYPE html>
+// Сгенерировано tools/pages.py из Hub/pages, вручную не править.
+
+typedef enum { PAGE_FIELD_SSID_VAL, PAGE_FIELD_PASS_VAL, PAGE_FIELD_WQTT_TOKEN_VAL, PAGE_FIELD_LATITUDE_VAL, PAGE_FIELD_LONGITUDE_VAL, PAGE_FIELD_NONE } PageField;
+
+struct PageSegment {
+    const char *text;
+    PageField field;
+};
+
+struct Asset {
+    const char *path;
+    const char *type;
+    const uint8_t *data;
+    size_t size;
+};
+
+constexpr char PAGE_INDEX_0[] PROGMEM = R"rawliteral(<!DOCTYPE html>
 <html>
 <head>
   <meta charset="UTF-8">
   <title>Настройка Умного Полива</title>
-  <style>
-    body { font-family: Arial, sans-serif; margin: 20px; background-color: #f4f4f4; color: #333; display: flex; justify-content: center; align-items: center; min-height: 90vh; }
-    .container { background-color: #fff; padding: 30px; border-radius: 8px; box-shadow: 0 0 15px rgba(0,0,0,0.2); width: 100%; max-width: 400px; }
-    h2 { color: #0056b3; text-align: center; margin-bottom: 20px;}
-    label { display: block; margin-bottom: 8px; font-weight: bold; }
-    input[type="text"], input[type="password"], input[type="number"] {
-      width: calc(100% - 22px); padding: 10px; margin-bottom: 15px; border: 1px solid #ddd; border-radius: 4px; box-sizing: border-box;
-    }
-    button { background-color: #5cb85c; color: white; padding: 10px 15px; border: none; border-radius: 4px; cursor: pointer; font-size: 14px; margin-bottom:15px; width:100%; }
-    button:hover { background-color: #4cae4c; }
-    input[type="submit"] {
-      background-color: #0056b3; color: white; padding: 12px 20px; border: none; border-radius: 4px; cursor: pointer; font-size: 16px; width: 100%;
-    }
-    input[type="submit"]:hover { background-color: #004494; }
-    .message { padding: 10px; margin-top: 20px; margin-bottom: 0px; border-radius: 4px; text-align: center;}
-    .success { background-color: #d4edda; color: #155724; border: 1px solid #c3e6cb; }
-    .error { background-color: #f8d7da; color: #721c24; border: 1px solid #f5c6cb; }
-    a { color: #0056b3; text-decoration: none; }
-    a:hover { text-decoration: underline; }
-    .footer-link { text-align: center; margin-top: 15px; }
-    #location_status { font-size: 0.9em; margin-bottom: 10px; min-height:1.2em; }
-  </style>
+  <link rel="stylesheet" href="/style.css">
 </head>
 <body>
   <div class="container">
     <h2>Настройки Умного Полива</h2>
     <form method="POST" action="/">
       <label for="ssid">WiFi SSID:</label>
-      <input type="text" id="ssid" name="ssid" value="%SSID_VAL%">
+      <input type="text" id="ssid" name="ssid" value=")rawliteral";
+constexpr char PAGE_INDEX_1[] PROGMEM = R"rawliteral(">
 
       <label for="password">WiFi Password:</label>
-      <input type="password" id="password" name="password" value="%PASS_VAL%">
+      <input type="password" id="password" name="password" value=")rawliteral";
+constexpr char PAGE_INDEX_2[] PROGMEM = R"rawliteral(">
 
       <label for="token">WQTT API Token:</label>
-      <input type="text" id="token" name="token" value="%WQTT_TOKEN_VAL%">
+      <input type="text" id="token" name="token" value=")rawliteral";
+constexpr char PAGE_INDEX_3[] PROGMEM = R"rawliteral(">
 
       <hr style="margin: 20px 0;">
 
       <label for="latitude">Широта (Latitude):</label>
-      <input type="number" step="any" id="latitude" name="latitude" value="%LATITUDE_VAL%" required>
+      <input type="number" step="any" id="latitude" name="latitude" value=")rawliteral";
+constexpr char PAGE_INDEX_4[] PROGMEM = R"rawliteral(" required>
 
       <label for="longitude">Долгота (Longitude):</label>
-      <input type="number" step="any" id="longitude" name="longitude" value="%LONGITUDE_VAL%" required>
+      <input type="number" step="any" id="longitude" name="longitude" value=")rawliteral";
+constexpr char PAGE_INDEX_5[] PROGMEM = R"rawliteral(" required>
 
       <hr style="margin: 20px 0;">
       <input type="submit" value="Сохранить">
@@ -58,53 +57,122 @@ constexpr char HTML_PAGE_INDEX[] PROGMEM = R"rawliteral(
     <button type="button" onclick="confirmReset()" style="background-color: #d9534f; margin-top: 10px;">Сбросить настройки до заводских</button>
     <div id="message-container" style="margin-top: 20px;"></div>
   </div>
-  <script>
-    function showPosition(position) {
-      document.getElementById('latitude').value = position.coords.latitude.toFixed(6);
-      document.getElementById('longitude').value = position.coords.longitude.toFixed(6);
-      document.getElementById("location_status").innerHTML = "Координаты получены!";
-    }
-
-    function showError(error) {
-      var statusP = document.getElementById("location_status");
-      switch(error.code) {
-        case error.PERMISSION_DENIED:
-          statusP.innerHTML = "Запрос геолокации отклонен."
-          break;
-        case error.POSITION_UNAVAILABLE:
-          statusP.innerHTML = "Информация о местоположении недоступна."
-          break;
-        case error.TIMEOUT:
-          statusP.innerHTML = "Тайм-аут запроса геолокации."
-          break;
-        case error.UNKNOWN_ERROR:
-          statusP.innerHTML = "Неизвестная ошибка геолокации."
-          break;
-      }
-    }
-
-    function confirmReset() {
-      var messageDiv = document.getElementById('message-container');
-      messageDiv.innerHTML = '';
-      if (confirm("Вы уверены, что хотите сбросить все настройки до заводских? Это действие необратимо и приведет к перезагрузке устройства.")) {
-        messageDiv.innerHTML = '<p>Выполняется сброс...</p>';
-        fetch('/reset', { method: 'POST' })
-          .then(response => {
-            if (!response.ok) {
-              throw new Error('Network response was not ok: ' + response.statusText);
-            }
-            return response.text();
-          })
-          .then(data => {
-            messageDiv.innerHTML = '<p class="success">' + data + '</p>';
-          })
-          .catch(error => {
-            console.error('Error during reset:', error);
-            messageDiv.innerHTML = '<p class="error">Ошибка при сбросе настроек: ' + error.message + '</p>';
-          });
-      }
-    }
-  </script>
+  <script src="/index.js"></script>
 </body>
 </html>
 )rawliteral";
+
+constexpr PageSegment PAGE_INDEX[] = {
+    {PAGE_INDEX_0, PAGE_FIELD_SSID_VAL},
+    {PAGE_INDEX_1, PAGE_FIELD_PASS_VAL},
+    {PAGE_INDEX_2, PAGE_FIELD_WQTT_TOKEN_VAL},
+    {PAGE_INDEX_3, PAGE_FIELD_LATITUDE_VAL},
+    {PAGE_INDEX_4, PAGE_FIELD_LONGITUDE_VAL},
+    {PAGE_INDEX_5, PAGE_FIELD_NONE},
+};
+
+constexpr uint8_t ASSET_INDEX_JS_DATA[] PROGMEM = {
+    0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0x95, 0x54, 0x4D, 0x4F, 0xDB, 0x40,
+    0x10, 0xBD, 0xF3, 0x2B, 0x06, 0x5F, 0xEC, 0x08, 0x30, 0xB7, 0x1E, 0x08, 0xA4, 0x02, 0x91, 0xAA,
+    0x51, 0x21, 0x41, 0x21, 0xB4, 0x47, 0xE4, 0xDA, 0x1B, 0x62, 0x11, 0xBC, 0xC8, 0xDE, 0x10, 0x2A,
+    0x84, 0xC4, 0x47, 0x29, 0x95, 0xA8, 0x84, 0xD4, 0x4B, 0xAB, 0x4A, 0xED, 0xA1, 0xF7, 0x4A, 0x7C,
+    0xA5, 0x04, 0x0A, 0xE1, 0x2F, 0xEC, 0xFE, 0xA3, 0xCE, 0x78, 0x9D, 0x0F, 0x28, 0x04, 0x1A, 0xC9,
+    0x91, 0xBD, 0x3B, 0xFB, 0xDE, 0x9B, 0x37, 0x33, 0x5B, 0xAE, 0x05, 0xAE, 0xF0, 0x79, 0x00, 0x51,
+    0x85, 0xD7, 0xE7, 0x78, 0xE4, 0xD3, 0x87, 0xB5, 0x9A, 0xBC, 0xA4, 0x60, 0x63, 0x00, 0xC0, 0xE3,
+    0x6E, 0x6D, 0x85, 0x05, 0xC2, 0x5E, 0x62, 0x22, 0x5B, 0x65, 0xF4, 0x3A, 0xF5, 0x2E, 0xE7, 0x59,
+    0x66, 0xD5, 0x11, 0xBE, 0xA8, 0x79, 0xCC, 0x4C, 0xD9, 0x6B, 0x4E, 0xB5, 0xC6, 0x60, 0x02, 0xDA,
+    0x27, 0x6D, 0x97, 0xF3, 0xD0, 0x8B, 0xEC, 0x76, 0x88, 0x2D, 0xF8, 0x0B, 0x7F, 0x9D, 0x79, 0xD6,
+    0xB3, 0x54, 0xBA, 0x2F, 0x24, 0x0F, 0x96, 0x1E, 0xC5, 0x6C, 0xC7, 0x3C, 0x11, 0xD4, 0xA8, 0x72,
+    0xD7, 0x21, 0x80, 0xC5, 0x48, 0x38, 0xA2, 0x16, 0x19, 0x29, 0xDB, 0x0F, 0x02, 0x16, 0xBE, 0x2C,
+    0xCD, 0xCE, 0x20, 0xBC, 0x21, 0xBF, 0xC9, 0x96, 0x6C, 0xA9, 0x2D, 0x79, 0x26, 0x9B, 0xF2, 0x5A,
+    0x1E, 0xA9, 0x1D, 0x75, 0x00, 0xF2, 0x06, 0x17, 0xFF, 0xA8, 0x5D, 0xB5, 0x2F, 0x1B, 0xF2, 0x5A,
+    0x1D, 0x0C, 0x1A, 0xE9, 0x81, 0xCD, 0x81, 0x81, 0x72, 0xAF, 0x5F, 0xD9, 0x30, 0xE4, 0xA1, 0xC5,
+    0xE8, 0x5F, 0x3B, 0xB5, 0xE6, 0x84, 0xA0, 0x39, 0xE6, 0x10, 0xF8, 0xE9, 0x7A, 0x48, 0x7D, 0x54,
+    0xF7, 0x85, 0x5B, 0xD1, 0x68, 0x98, 0xA9, 0xC7, 0x34, 0x24, 0x80, 0xEB, 0x44, 0x0C, 0xF4, 0xF2,
+    0x5C, 0xB6, 0x38, 0x9B, 0x9B, 0x9F, 0xCF, 0x15, 0xF2, 0x8B, 0xD3, 0xD9, 0x7C, 0x2E, 0x3B, 0x3D,
+    0x16, 0x47, 0x40, 0x9B, 0xF4, 0x4E, 0x5E, 0x5F, 0xE4, 0x91, 0xBC, 0xC1, 0xBC, 0x5A, 0x6A, 0x1B,
+    0xE4, 0x29, 0xE6, 0x81, 0x19, 0xE1, 0x73, 0x89, 0x29, 0x7E, 0xC0, 0x54, 0x9B, 0x80, 0x3B, 0x3B,
+    0xF8, 0x49, 0x8B, 0xD7, 0x94, 0xA6, 0x6D, 0x24, 0x78, 0x6F, 0x43, 0xE6, 0x2C, 0xA7, 0xFF, 0xA1,
+    0x2F, 0xCC, 0xE7, 0x4A, 0x44, 0xBE, 0x90, 0x9F, 0x7C, 0x3D, 0x99, 0x9B, 0x99, 0x9C, 0x9A, 0xC9,
+    0xF6, 0x57, 0xF0, 0x15, 0xAD, 0x7B, 0x1F, 0x7B, 0x7B, 0xA5, 0x49, 0xD5, 0x21, 0x92, 0x02, 0x7E,
+    0x35, 0xD4, 0x36, 0x72, 0xB7, 0xB4, 0xCD, 0xF8, 0xFC, 0x26, 0x7E, 0x2D, 0x8A, 0xA4, 0x9C, 0x91,
+    0x68, 0x2C, 0xC4, 0x2E, 0x06, 0x60, 0x49, 0x1E, 0x11, 0x56, 0xCA, 0xCD, 0x66, 0x0B, 0x0B, 0xA5,
+    0xFE, 0x5A, 0x7E, 0xA2, 0x1B, 0x17, 0xF2, 0x6A, 0x04, 0x85, 0xEC, 0xAA, 0x1D, 0x90, 0xE7, 0x5D,
+    0x77, 0xE4, 0xD1, 0xBD, 0xFE, 0x3C, 0xC2, 0xBA, 0x90, 0x7F, 0x95, 0x2F, 0xBC, 0xC9, 0x2F, 0x66,
+    0x8B, 0xC5, 0x42, 0xB1, 0x3F, 0xF7, 0x77, 0x04, 0x6F, 0x22, 0xE3, 0x49, 0x92, 0x37, 0x75, 0x19,
+    0x39, 0xA1, 0x3E, 0xE2, 0xF2, 0x31, 0x31, 0x3E, 0x51, 0xC0, 0xE6, 0xAD, 0x26, 0x74, 0x79, 0x50,
+    0xF6, 0xC3, 0x95, 0x22, 0x8B, 0x98, 0xB0, 0xBA, 0x2D, 0xB8, 0xC2, 0xA2, 0xC8, 0x59, 0x62, 0xD3,
+    0xFE, 0x5A, 0x9F, 0x2E, 0x34, 0x93, 0xA8, 0x11, 0x04, 0x11, 0x8E, 0x8F, 0x6A, 0xCD, 0xB8, 0x0F,
+    0xBB, 0x87, 0x6F, 0xE5, 0x60, 0x9A, 0xB4, 0xE9, 0x97, 0xC1, 0x4A, 0x48, 0x2D, 0x43, 0x7E, 0xC6,
+    0x39, 0xC1, 0x0A, 0x51, 0x52, 0x5B, 0x7A, 0x4A, 0x86, 0x41, 0xED, 0x53, 0x59, 0x41, 0xED, 0xC5,
+    0xBD, 0xD5, 0xC4, 0xA7, 0x01, 0x68, 0xF0, 0x71, 0x62, 0x34, 0x2E, 0xA8, 0x4F, 0x20, 0x4F, 0xF0,
+    0xB5, 0x01, 0xB1, 0x0D, 0x54, 0x65, 0xDC, 0xC3, 0xD2, 0x5C, 0x52, 0xF1, 0xCF, 0xA8, 0x3D, 0xA8,
+    0x34, 0x27, 0xB8, 0x76, 0x86, 0x61, 0xB8, 0xAA, 0xF6, 0x9E, 0x83, 0xFC, 0x15, 0xE3, 0xE2, 0x7E,
+    0x43, 0x5E, 0xC4, 0x1E, 0x9E, 0xA0, 0x43, 0x0D, 0xDD, 0x2D, 0xAD, 0x18, 0xFF, 0x88, 0x08, 0xB1,
+    0xB5, 0x30, 0x0A, 0x81, 0xA8, 0xB4, 0x4D, 0xD2, 0x46, 0x47, 0xA8, 0xDE, 0x97, 0x34, 0xD3, 0x5A,
+    0x29, 0xE1, 0x9F, 0xAA, 0x2D, 0xD4, 0x7E, 0x8E, 0xF8, 0x28, 0x70, 0xB7, 0x2B, 0x23, 0xC1, 0xC6,
+    0x96, 0x4B, 0xB5, 0x27, 0xF0, 0x21, 0x4B, 0xC6, 0x57, 0x33, 0xE4, 0x41, 0xD2, 0xC3, 0xD7, 0xEA,
+    0x90, 0x88, 0xF0, 0xFC, 0x61, 0x4F, 0xC6, 0xB6, 0x6D, 0x8F, 0x8F, 0xAE, 0x66, 0x4C, 0xDD, 0x3D,
+    0x65, 0x46, 0x33, 0x6E, 0x8E, 0x86, 0x54, 0x31, 0x73, 0x18, 0x36, 0x10, 0x5B, 0x54, 0xB8, 0x37,
+    0x06, 0x26, 0x0E, 0x57, 0xC9, 0x84, 0xCD, 0x54, 0x52, 0x71, 0x5B, 0x54, 0x58, 0x60, 0x61, 0xDC,
+    0x2A, 0x0F, 0xB0, 0xE3, 0x26, 0x32, 0x89, 0x16, 0xFA, 0x51, 0x15, 0x06, 0xDB, 0x5B, 0x36, 0x5F,
+    0x4E, 0xF5, 0xEC, 0x01, 0x88, 0x4A, 0xC8, 0xEB, 0x10, 0xB0, 0x3A, 0xE8, 0xFB, 0xC9, 0xCC, 0x33,
+    0x51, 0xE7, 0xE1, 0x32, 0x74, 0xC0, 0xEA, 0x4E, 0x04, 0x01, 0x17, 0xC0, 0x97, 0x91, 0x17, 0x86,
+    0x3A, 0x1B, 0xB6, 0x6E, 0xDE, 0x12, 0x5B, 0x17, 0xA9, 0x74, 0x07, 0x71, 0xB3, 0xF3, 0x16, 0x32,
+    0x51, 0x0B, 0x83, 0x6E, 0xB8, 0xC0, 0x40, 0xAB, 0x13, 0x79, 0x47, 0xBA, 0xE7, 0x08, 0xE7, 0xB6,
+    0xEC, 0x87, 0x6D, 0x04, 0xB7, 0xEA, 0x44, 0xD1, 0x84, 0x11, 0xD5, 0x5C, 0x17, 0x83, 0x8C, 0x0C,
+    0xA9, 0x8A, 0x01, 0x86, 0x70, 0xBB, 0x6B, 0x5F, 0x2F, 0x09, 0x5E, 0xA1, 0xED, 0xEB, 0xF2, 0x36,
+    0x0D, 0xF6, 0x67, 0xC4, 0xAB, 0xCC, 0x66, 0x3A, 0xFB, 0xD8, 0x04, 0xF0, 0x6A, 0xA1, 0x1F, 0x2C,
+    0x41, 0xEC, 0xFB, 0x18, 0x1A, 0xAF, 0x2F, 0xED, 0xF4, 0x7F, 0x68, 0x8B, 0x4F, 0x18, 0x19, 0xF9,
+    0xA3, 0x77, 0x66, 0xE3, 0x26, 0xEB, 0xED, 0xEF, 0x3B, 0x4D, 0xDD, 0x90, 0x97, 0xDA, 0x62, 0x7D,
+    0x63, 0x24, 0x2C, 0xF7, 0x64, 0xD5, 0x9E, 0xED, 0xBF, 0xBC, 0x6A, 0xE0, 0xFE, 0x90, 0x07, 0x00,
+    0x00,
+};
+
+constexpr uint8_t ASSET_STYLE_CSS_DATA[] PROGMEM = {
+    0x1F, 0x8B, 0x08, 0x00, 0x00, 0x00, 0x00, 0x00, 0x02, 0x03, 0xA5, 0x54, 0xDB, 0x8E, 0x9B, 0x30,
+    0x14, 0x7C, 0xE7, 0x2B, 0xAC, 0x44, 0x95, 0x76, 0xA5, 0x10, 0x11, 0x02, 0xB9, 0x80, 0xFA, 0xD0,
+    0xEF, 0xA8, 0x56, 0x95, 0x6F, 0x80, 0x1B, 0x63, 0x23, 0xDB, 0x6C, 0x92, 0xAE, 0xF2, 0xEF, 0x3D,
+    0x18, 0x48, 0xA2, 0x84, 0xF4, 0xA5, 0xB2, 0x14, 0x09, 0xE7, 0x78, 0x3C, 0x33, 0x67, 0x7C, 0x88,
+    0x66, 0x67, 0xF4, 0x85, 0x0A, 0xAD, 0x5C, 0x58, 0xE0, 0x5A, 0xC8, 0x73, 0x86, 0x7E, 0x18, 0x81,
+    0xE5, 0x02, 0x59, 0xAC, 0x6C, 0x68, 0xB9, 0x11, 0x45, 0x8E, 0x6A, 0x6C, 0x4A, 0xA1, 0x32, 0x14,
+    0x47, 0xCD, 0x29, 0x47, 0x04, 0xD3, 0x43, 0x69, 0x74, 0xAB, 0x58, 0x48, 0xB5, 0xD4, 0x26, 0x43,
+    0xF3, 0x22, 0xE9, 0x56, 0x8E, 0xC6, 0xEF, 0xF5, 0x7A, 0x9D, 0x23, 0x26, 0x6C, 0x23, 0x31, 0x20,
+    0x16, 0x92, 0xC3, 0xB1, 0xDF, 0xAD, 0x75, 0xA2, 0x38, 0xC3, 0x19, 0xE5, 0xB8, 0x72, 0x19, 0xA2,
+    0xF0, 0xCB, 0x4D, 0x8E, 0xB0, 0x14, 0xA5, 0x0A, 0x85, 0xE3, 0xB5, 0xBD, 0x6D, 0xD6, 0x42, 0x85,
+    0x15, 0x17, 0x65, 0x05, 0x85, 0xFB, 0xE8, 0xB3, 0xCA, 0xD1, 0x25, 0x58, 0x76, 0x47, 0xB1, 0x50,
+    0xDC, 0x00, 0xE7, 0x29, 0x16, 0x05, 0x70, 0x6D, 0x30, 0x63, 0x42, 0x95, 0x19, 0x5A, 0xF7, 0x64,
+    0xB5, 0x61, 0xDC, 0x84, 0x06, 0x33, 0xD1, 0x02, 0xFC, 0xAE, 0xDF, 0x3B, 0x85, 0xB6, 0xC2, 0x4C,
+    0x1F, 0x33, 0x14, 0xC1, 0x5A, 0xA5, 0xCD, 0x09, 0x99, 0x92, 0xE0, 0xB7, 0x68, 0xE1, 0xD7, 0x32,
+    0x7E, 0xCF, 0xD1, 0x51, 0x30, 0x57, 0x65, 0x68, 0x15, 0x45, 0xDF, 0x3A, 0x07, 0x4E, 0xE1, 0xB0,
+    0x91, 0x44, 0x1E, 0xF8, 0x12, 0x54, 0x31, 0xD0, 0x18, 0xEF, 0x8E, 0xA2, 0x74, 0x43, 0x40, 0xB4,
+    0xE3, 0x27, 0x17, 0x7A, 0x45, 0x77, 0x5A, 0xBC, 0x7D, 0x21, 0xD1, 0xCE, 0xE9, 0x7A, 0x70, 0xF1,
+    0x12, 0x48, 0x4C, 0xB8, 0x04, 0x84, 0xAB, 0x4D, 0x44, 0x6A, 0x7A, 0x78, 0xAA, 0xF6, 0x8C, 0x7D,
+    0x83, 0x8E, 0x83, 0x1D, 0x44, 0x4B, 0xD6, 0xDD, 0x2F, 0x54, 0xD3, 0xBA, 0x9F, 0xEE, 0xDC, 0xF0,
+    0xEF, 0xB3, 0xEE, 0xDA, 0xD9, 0xC7, 0x02, 0xDD, 0xEF, 0x35, 0xD8, 0xDA, 0x23, 0xC8, 0x7F, 0xDC,
+    0x57, 0x6D, 0x4D, 0xB8, 0x99, 0x7D, 0xA0, 0xAF, 0x00, 0x8D, 0x2A, 0x29, 0x96, 0xF4, 0xAD, 0x93,
+    0x8A, 0x42, 0x14, 0xC7, 0xCD, 0xE9, 0xFD, 0xCE, 0xC8, 0x95, 0xD7, 0xFB, 0x40, 0xAB, 0xF3, 0x6C,
+    0x74, 0x17, 0xBE, 0xC0, 0x40, 0xAB, 0xA5, 0x60, 0x68, 0xCE, 0x18, 0x7B, 0x72, 0x3D, 0xB9, 0xBA,
+    0x2E, 0xFE, 0x78, 0xC8, 0xE1, 0x7F, 0xD8, 0xCA, 0x83, 0x4B, 0x40, 0x5A, 0xC0, 0x54, 0xD3, 0x3D,
+    0x4D, 0x29, 0xD9, 0xA5, 0xF4, 0x9A, 0xAC, 0x63, 0x05, 0x39, 0x79, 0xE0, 0xF6, 0xC0, 0x45, 0x69,
+    0xC5, 0xA7, 0x19, 0xD0, 0xD6, 0xD8, 0x0E, 0xA4, 0xD1, 0xA2, 0x6F, 0x8C, 0xB7, 0x15, 0x38, 0x71,
+    0x00, 0x4A, 0x9E, 0x45, 0xF6, 0xB8, 0xBD, 0x43, 0x7D, 0x0C, 0x46, 0xAE, 0x59, 0xA5, 0x3F, 0x5F,
+    0xA5, 0x30, 0xA1, 0x98, 0x27, 0xF4, 0xB1, 0x41, 0xB6, 0x25, 0xB5, 0x70, 0x83, 0xE9, 0x13, 0xA7,
+    0xC6, 0xFC, 0xBC, 0xD2, 0x09, 0x3D, 0x19, 0x9F, 0xDF, 0xFF, 0xE9, 0xDC, 0xDC, 0x34, 0xF5, 0xD9,
+    0x0E, 0xA6, 0x89, 0xFE, 0x4B, 0x62, 0x14, 0x25, 0xC9, 0x3E, 0xF1, 0x4F, 0xB2, 0xE6, 0xD6, 0xE2,
+    0x92, 0x43, 0xDD, 0x74, 0x5E, 0x9C, 0x6E, 0xC6, 0xB9, 0xF1, 0x90, 0xA0, 0xA9, 0xE7, 0xE9, 0xE9,
+    0x4F, 0x3C, 0x21, 0xB8, 0xC8, 0xB6, 0x94, 0xC2, 0x5D, 0xD3, 0x84, 0x58, 0xC2, 0x19, 0xC3, 0xB7,
+    0xF9, 0xB3, 0x4A, 0xD3, 0x6D, 0x9C, 0x4C, 0xE6, 0x93, 0xAE, 0xF9, 0x86, 0x12, 0xCF, 0x9D, 0x1B,
+    0xA3, 0x5F, 0x8D, 0x92, 0x1D, 0xDB, 0xDE, 0x03, 0x6E, 0xE3, 0x15, 0x7D, 0x01, 0x58, 0xA4, 0x74,
+    0x00, 0xC4, 0xAF, 0xE6, 0x01, 0xE3, 0x54, 0x1B, 0xEC, 0x04, 0x04, 0x67, 0x68, 0x1B, 0x14, 0x5F,
+    0x0D, 0x7E, 0x2A, 0x01, 0x22, 0xDC, 0x48, 0xD1, 0xD7, 0x2D, 0x0B, 0xAD, 0xC1, 0x82, 0x10, 0xBE,
+    0x0F, 0x63, 0xF1, 0xF4, 0x7C, 0xF1, 0x56, 0xF7, 0x99, 0xBD, 0x04, 0x73, 0x18, 0x26, 0x1E, 0xEE,
+    0x97, 0x75, 0xD8, 0xB5, 0x76, 0x9C, 0xF2, 0x7D, 0x0A, 0xA2, 0xE5, 0x9E, 0xD7, 0xCF, 0x6F, 0xBA,
+    0x6F, 0xD3, 0x6D, 0xF2, 0xAE, 0x96, 0x71, 0x57, 0x76, 0x09, 0xFE, 0x02, 0x81, 0x59, 0x8E, 0x0F,
+    0x28, 0x06, 0x00, 0x00,
+};
+
+constexpr Asset ASSETS[] = {
+    {"/index.js", "application/javascript", ASSET_INDEX_JS_DATA, sizeof(ASSET_INDEX_JS_DATA)},
+    {"/style.css", "text/css", ASSET_STYLE_CSS_DATA, sizeof(ASSET_STYLE_CSS_DATA)},
+};
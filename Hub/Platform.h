@@ -0,0 +1,72 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <EEPROM.h>
+
+/*
+ * Платформенно-зависимая часть прошивки хаба.
+ * Остальной код работает с железом только через Arduino API и эти функции,
+ * поэтому сборка под другую плату или под хост сводится к замене этого файла.
+ */
+
+inline HardwareSerial &radioSerial() { return Serial2; }
+
+// Эмуляция EEPROM на ESP32 — один блоб в NVS, и begin() с меньшим размером его обрезает.
+// Поэтому все хранилища открывают его целиком, а их размер сверяется с STORAGE_SIZE при сборке.
+constexpr size_t STORAGE_SIZE = 4096;
+
+inline void storageBegin(const size_t) { EEPROM.begin(STORAGE_SIZE); }
+
+inline uint8_t storageRead(const size_t address) { return EEPROM.read(address); }
+
+inline void storageWrite(const size_t address, const uint8_t value) { EEPROM.write(address, value); }
+
+inline void storageEnd(const bool commit) {
+    if (commit) EEPROM.commit();
+    EEPROM.end();
+}
+
+inline void platformRestart() { ESP.restart(); }
+
+inline uint32_t platformHeapFree() { return ESP.getFreeHeap(); }
+
+inline uint32_t platformHeapLargest() { return ESP.getMaxAllocHeap(); }
+
+inline void *platformTask() { return xTaskGetCurrentTaskHandle(); }
+
+typedef TaskHandle_t PlatformTaskHandle;
+
+// Задача с собственным циклом на заданном ядре.
+inline void platformTaskStart(void (*body)(void *), const char *name, const uint32_t stack, const unsigned int priority,
+                              const int core, PlatformTaskHandle &handle) {
+    xTaskCreatePinnedToCore(body, name, stack, nullptr, priority, &handle, core);
+}
+
+// Отдаёт ядро другим задачам того же приоритета и сторожевому таймеру до следующего тика.
+inline void platformYield() { vTaskDelay(1); }
+
+// Завершает вызвавшую задачу; возврата нет.
+inline void platformTaskExit() { vTaskDelete(nullptr); }
+
+// Наименьший запас стека задачи за всё время, в словах.
+inline uint32_t platformTaskStack(const PlatformTaskHandle handle) { return uxTaskGetStackHighWaterMark(handle); }
+
+// Короткая критическая секция между ядрами: спинлок FreeRTOS, на время которого прерывания ядра запрещены.
+class PlatformLock {
+public:
+    void lock() { portENTER_CRITICAL(&mux); }
+    void unlock() { portEXIT_CRITICAL(&mux); }
+
+private:
+    portMUX_TYPE mux = portMUX_INITIALIZER_UNLOCKED;
+};
+
+// Контекст исполнения — ядро: на одном радиозадача, на другом loop() и сеть.
+constexpr size_t LOG_CONTEXTS = 2;
+
+inline size_t platformContext() { return xPortGetCoreID(); }
+
+// Причина последнего сброса в кодах esp_reset_reason_t: отличает просадку питания от перезапуска.
+inline int platformResetReason() { return esp_reset_reason(); }
+
+#endif
@@ -0,0 +1,69 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "../Common/Log.h"
+
+/*
+ * Кооперативный планировщик.
+ * Задача — короткая функция без delay(), которая вызывается не чаще раза в interval мс.
+ * Долгие операции разбиваются на шаги конечного автомата, так что каждая задача
+ * быстро возвращает управление и радио обслуживается с ограниченным интервалом.
+ *
+ * Граница держится только для списка радиозадачи. В списке сетевой задачи шаги mqttClient.connect
+ * и запросы HTTPS блокируют свой тик на время соединения: до MQTT_TIMEOUT и HTTP_TIMEOUT на шаг.
+ * Радио этого не замечает, потому что радиомост работает отдельной задачей на другом ядре.
+ */
+
+struct Task {
+    const char *name;
+    void (*run)();
+    unsigned long interval;
+
+    unsigned long last = 0;
+    unsigned long runs = 0;
+    unsigned long timeTotal = 0;
+    unsigned long timeMax = 0;
+};
+
+inline bool timerElapsed(const unsigned long since, const unsigned long interval) {
+    return millis() - since >= interval;
+}
+
+inline void taskRun(Task &task) {
+    const unsigned long start = micros();
+    task.run();
+    const unsigned long time = micros() - start;
+
+    task.runs++;
+    task.timeTotal += time;
+    if (time > task.timeMax) task.timeMax = time;
+}
+
+template<size_t N>
+void schedulerLoop(Task (&tasks)[N]) {
+    for (Task &task: tasks) {
+        if (task.runs > 0 && !timerElapsed(task.last, task.interval)) continue;
+        task.last = millis();
+        taskRun(task);
+    }
+}
+
+// Суммарное время работы задач в мкс; разность двух замеров — занятость за интервал.
+template<size_t N>
+unsigned long schedulerBusy(const Task (&tasks)[N]) {
+    unsigned long busy = 0;
+    for (const Task &task: tasks) busy += task.timeTotal;
+    return busy;
+}
+
+// В журнал задача попадает номером списка и своим номером в нём: имён в двоичной записи нет.
+template<size_t N>
+void schedulerReport(const uint8_t list, const Task (&tasks)[N]) {
+    for (size_t i = 0; i < N; i++) {
+        const Task &task = tasks[i];
+        const unsigned long average = task.runs > 0 ? task.timeTotal / task.runs : 0;
+        LOG_INFO(LOG_TASK, list, i, task.runs, average, task.timeMax);
+    }
+}
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <string.h>
+
+/*
+ * Передача таблицы, которой владеет задача одного ядра, задаче другого ядра.
+ * Владелец правит свою копию и после изменения публикует её целиком, а другая задача забирает
+ * последнюю опубликованную. Копирование идёт под PlatformLock из Platform.h, поэтому Platform.h
+ * подключается раньше этого файла, а забранная копия всегда целая и годится для подсчёта CRC.
+ */
+
+template<typename T>
+class Snapshot {
+public:
+    void publish(const T &value) {
+        lock.lock();
+        memcpy(&shared, &value, sizeof(T));
+        changed = true;
+        lock.unlock();
+    }
+
+    // Возвращает false, если с прошлого раза ничего не публиковалось.
+    bool take(T &value) {
+        lock.lock();
+        const bool taken = changed;
+        if (taken) memcpy(&value, &shared, sizeof(T));
+        changed = false;
+        lock.unlock();
+        return taken;
+    }
+
+private:
+    PlatformLock lock;
+    T shared;
+    bool changed = false;
+};
+
+#endif
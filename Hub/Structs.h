@@ -2,6 +2,155 @@
 #define STRUCTS_H
 #endif
 
+#include "../Common/Protocol.h"
+#include "../Common/RingBuffer.h"
+#include "Histogram.h"
+
+constexpr int NODES_MAX = 16;
+
+struct Node {
+    uint32_t addressHigh;
+    uint32_t addressLow;
+    int DEVICE_ID;
+    uint8_t zones;
+    bool legacy;
+    bool sleepy;
+};
+
+constexpr uint8_t OUTBOX_MAX = 8;
+constexpr uint8_t LINK_WINDOW = 4;
+
+// Кадр команды, ждущий места в окне отправки или пробуждения спящего узла.
+struct Pending {
+    uint8_t length;
+    uint8_t data[sizeof(ForecastFrame)];
+};
+
+// Отправленная команда, ждущая LinkAckFrame; seq == 0 — свободный слот окна.
+struct Inflight {
+    uint8_t seq;
+    uint8_t frameId;
+    uint8_t retries;
+    unsigned long first;
+    unsigned long sent;
+    Pending frame;
+};
+
+// Расхождение настроек уходит одним кадром из очереди узла; что не поместилось, уйдёт после следующего отчёта.
+constexpr uint8_t STATE_DIFF_MAX = (sizeof(Pending::data) - sizeof(FrameHeader)) / sizeof(StateEntry);
+
+// Настройки узла в тех же единицах, что и в командах; 0xFF (у heartbeat 0xFFFF) — значение неизвестно,
+// поэтому стёртая память читается как пустая тень.
+struct Shadow {
+    uint8_t reference[ZONES_MAX];
+    uint8_t mode[ZONES_MAX];
+    uint8_t lookahead;
+    uint8_t deadband;
+    uint16_t heartbeat;
+    uint8_t sleep;
+};
+
+struct LinkStats {
+    uint32_t delivered;
+    uint32_t retries;
+    uint32_t failed;
+    uint32_t txFailures;
+    uint32_t latencyTotal;
+    uint32_t latencyMax;
+};
+
+constexpr uint8_t OUTBOUND_MAX = 32;
+
+// Сообщение, ждущее отправки брокеру.
+// queued — время приёма кадра, из которого получено сообщение; 0 у собственных сообщений хаба.
+struct Outbound {
+    char topic[64];
+    char payload[96];
+    unsigned long queued;
+    bool retained;
+};
+
+// QUEUE_RETAINED заменяет неотправленное значение, как QUEUE_LATEST, и публикуется с флагом retain.
+typedef enum { QUEUE_LATEST, QUEUE_APPEND, QUEUE_RETAINED } QueuePolicy;
+
+constexpr size_t UPLINK_MAX = 32;
+constexpr size_t DOWNLINK_MAX = 16;
+
+// Сообщение радиозадачи, которое сетевая задача переложит в очередь брокера.
+struct Uplink {
+    QueuePolicy policy;
+    Outbound message;
+};
+
+// DOWNLINK_FRAME и DOWNLINK_LEGACY — кадр для узла, legacy-команда уходит строкой, без подтверждения доставки;
+// DOWNLINK_DESIRED — новое желаемое значение signal/zone в тени узла, которой владеет радиозадача;
+// DOWNLINK_DEVICE_ID и DOWNLINK_SLEEPY — value для одноимённого поля в таблице узлов радиозадачи.
+typedef enum : uint8_t { DOWNLINK_FRAME, DOWNLINK_LEGACY, DOWNLINK_DESIRED, DOWNLINK_DEVICE_ID, DOWNLINK_SLEEPY } DownlinkType;
+
+// Поручение сетевой задачи радиозадаче.
+struct Downlink {
+    uint8_t node;
+    DownlinkType type;
+    uint8_t signal;
+    uint8_t zone;
+    int32_t value;
+    Pending frame;
+};
+
+struct NodeState {
+    // Сессия устройства и следующий ожидаемый номер замера; sessionKnown — телеметрия пришла после загрузки хаба.
+    uint8_t session;
+    bool sessionKnown;
+    uint16_t sampleNext;
+    RingBuffer<Pending, OUTBOX_MAX> outbox;
+    uint8_t seqNext;
+    Inflight inflight[LINK_WINDOW];
+    LinkStats link;
+    // Время последнего кадра узла: по паузе перед ним хаб узнаёт, что спящий узел проснулся.
+    unsigned long heard;
+    // Последний отчёт узла о настройках; stateKnown — отчёт получен после загрузки хаба.
+    Shadow reported;
+    bool stateKnown;
+    unsigned long stateRequested;
+};
+
+// Последнее удачное подключение к WiFi: точка, канал и аренда адреса для быстрого старта.
+// channel == 0 — параметров нет; ssid — CRC имени сети, чтобы не применить их к другой сети;
+// leased — время получения адреса по DHCP, 0 — пока неизвестно.
+struct Network {
+    uint16_t ssid;
+    uint8_t channel;
+    uint8_t bssid[6];
+    uint32_t ip;
+    uint32_t gateway;
+    uint32_t subnet;
+    uint32_t dns;
+    uint32_t leased;
+};
+
+constexpr uint32_t LOOP_BUCKETS[] = {100, 500, 1000, 5000, 20000, 100000};
+constexpr uint32_t RELAY_BUCKETS[] = {10, 50, 200, 1000, 5000, 30000};
+
+// Счётчики хаба с момента загрузки; каждое поле пишет только одна задача.
+// Время итераций — в мкс, задержка от приёма кадра ZigBee до публикации в MQTT — в мс.
+struct Metrics {
+    uint32_t framesIn;
+    uint32_t framesOut;
+    uint32_t framesInvalid;
+    uint32_t mqttPublished;
+    uint32_t mqttFailed;
+    uint32_t httpsFailed;
+    Histogram<6> radioLoop{LOOP_BUCKETS};
+    Histogram<6> networkLoop{LOOP_BUCKETS};
+    Histogram<6> relay{RELAY_BUCKETS};
+};
+
+struct Forecast {
+    uint32_t time;
+    uint32_t fetched;
+    uint8_t rain[FORECAST_HOURS];
+};
+
 struct Config {
     char WIFI_SSID[64];
     char WIFI_PASSWORD[64];
@@ -11,6 +160,25 @@ struct Config {
     char MQTT_USERNAME[64];
     char MQTT_PASSWORD[64];
 
+    Node NODES[NODES_MAX];
+    char WQTT_TOKEN[64];
+
+    float WEATHER_LATITUDE;
+    float WEATHER_LONGITUDE;
+
+    Forecast FORECAST;
+};
+
+// Config прошивок до журнального хранилища: лежал целиком с адреса 0 и переносится при первой загрузке.
+struct LegacyConfig {
+    char WIFI_SSID[64];
+    char WIFI_PASSWORD[64];
+
+    char MQTT_HOST[64];
+    int MQTT_PORT;
+    char MQTT_USERNAME[64];
+    char MQTT_PASSWORD[64];
+
     int DEVICE_ID;
     char WQTT_TOKEN[64];
 
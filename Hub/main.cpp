@@ -7,199 +7,1217 @@
 #include <WiFiClientSecure.h>
 #include <WebServer.h>
 #include <XBee.h>
+#include <atomic>
+#include <sys/time.h>
 
+#include <Arena.h>
+#include <Certificates.h>
 #include <Constants.h>
 #include <Pages.h>
+#include <Platform.h>
+#include <Scheduler.h>
+#include <Snapshot.h>
+#include "../Common/ConfigStore.h"
+#include "../Common/HeapAudit.h"
+#include "../Common/Log.h"
+#include "../Common/Protocol.h"
+#include "../Common/SpscQueue.h"
 
 Config config;
+ConfigStore<Config, CONFIG_SCHEMA, CONFIG_SLOTS> configStore(config);
+// Таблица узлов радиозадачи; config.NODES — её копия сетевой задачи, полученная через nodesSnapshot.
+Node nodes[NODES_MAX];
+Snapshot<Node[NODES_MAX]> nodesSnapshot;
+Network network;
+ConfigStore<Network, NETWORK_SCHEMA, NETWORK_SLOTS, decltype(configStore)::END> networkStore(network);
+// Желаемые настройки узлов — последние значения из команд брокера; индексы совпадают с таблицей узлов.
+// shadows правит только радиозадача, а сетевая сохраняет их копию shadowsStored, полученную через shadowsSnapshot.
+Shadow shadows[NODES_MAX];
+Shadow shadowsStored[NODES_MAX];
+Snapshot<Shadow[NODES_MAX]> shadowsSnapshot;
+ConfigStore<Shadow[NODES_MAX], SHADOW_SCHEMA, SHADOW_SLOTS, decltype(networkStore)::END> shadowStore(shadowsStored);
+static_assert(decltype(shadowStore)::END <= STORAGE_SIZE, "Config stores must fit the EEPROM blob");
+NodeState nodeStates[NODES_MAX];
 
 WiFiClient wifiClient;
-WiFiClientSecure clientSecure;
+
+// Отдельный клиент на каждый сервер: HTTPClient держит соединение, только пока хост не меняется.
+struct HttpsOrigin {
+    WiFiClientSecure client;
+    HTTPClient http;
+};
+
+HttpsOrigin wqttOrigin;
+HttpsOrigin weatherOrigin;
+unsigned long httpsRequests;
+unsigned long httpsHandshakes;
+// Документы запросов к API живут в арене: куча не дробится от ежечасного прогноза.
+Arena<JSON_ARENA_SIZE> jsonArena;
+char httpBody[HTTP_BODY_MAX];
 
 WebServer webServer;
-HTTPClient httpClient;
 
 PubSubClient mqttClient(wifiClient);
 XBeeWithCallbacks xbeeClient;
 
-bool serverMode;
-unsigned long weatherLast = -WEATHER_INTERVAL;
+typedef enum { WIFI_IDLE, WIFI_CONNECTING, WIFI_CONNECTED, WIFI_FAILED } WifiState;
+typedef enum { MQTT_IDLE, MQTT_CONNECTING, MQTT_CONNECTED, MQTT_FAILED } MqttState;
+
+// Пишется в loop() на ядре 1, а читается задачей радиомоста на ядре 0.
+std::atomic<bool> serverMode{false};
+bool clientReady;
+WifiState wifiState;
+bool wifiFast;
+bool wifiStatic;
+MqttState mqttState;
+unsigned int mqttAttempts;
+unsigned long mqttDelay = MQTT_RETRY_INTERVAL;
+unsigned long mqttBackoff = MQTT_RETRY_INTERVAL;
+unsigned long mqttReconnects;
+unsigned long wifiLast;
+unsigned long mqttLast;
+unsigned long weatherLast;
+unsigned long weatherDelay;
+unsigned long registerLast = -REGISTER_INTERVAL;
+unsigned long restartLast;
+bool restartPending;
+
+RingBuffer<Outbound, OUTBOUND_MAX> outbound;
+unsigned long outboundDropped;
+
+/*
+ * Радиомост и сеть работают на разных ядрах и обмениваются только через две очереди:
+ * uplink пишет радиозадача, downlink — сетевая. Связь с узлами (nodes, nodeStates, shadows, XBee)
+ * принадлежит радиозадаче, брокер, HTTPS и хранилище настроек — сетевой. Таблицу узлов и тень настроек
+ * пишет только радиозадача: правки сетевой задачи (номер устройства, сон, желаемые значения) приходят ей
+ * через downlink, а обратно идут снимки nodesSnapshot и shadowsSnapshot, которые сетевая задача
+ * забирает в config.NODES и shadowsStored, ищет по ним узлы и сохраняет их.
+ */
+SpscQueue<Uplink, UPLINK_MAX> uplink;
+SpscQueue<Downlink, DOWNLINK_MAX> downlink;
+unsigned long uplinkDropped;
+unsigned long downlinkDropped;
+PlatformTaskHandle radioHandle;
+unsigned long cpuLast;
+unsigned long cpuRadioBusy;
+unsigned long cpuNetworkBusy;
+
+Metrics metrics;
+char metricsBuffer[METRICS_BUFFER_SIZE];
+
+bool bootFast;
+unsigned long bootRadio;
+unsigned long bootWifi;
+unsigned long bootMqtt;
 
 /* Настройки */
 
+// Строка старой раскладки: завершена нулём и без управляющих байтов; 0xFF в начале — стёртая память.
+bool legacyText(const char (&text)[64]) {
+    for (const char c: text) {
+        if (c == '\0') return true;
+        if (static_cast<uint8_t>(c) < 0x20 || static_cast<uint8_t>(c) == 0xFF) return false;
+    }
+    return false;
+}
+
+void legacyTextCopy(char (&to)[64], const char (&from)[64]) {
+    if (legacyText(from)) memcpy(to, from, sizeof(to));
+}
+
+// Настройки из старой раскладки переносятся один раз: первое сохранение пишет запись журнала поверх неё.
+// Номер устройства в облаке не переносится: старая раскладка не знает адреса узла, и узел регистрируется заново.
+void configImport() {
+    LegacyConfig legacy;
+    configStore.loadLegacy(legacy);
+    if (!legacyText(legacy.WIFI_SSID) || legacy.WIFI_SSID[0] == '\0') return;
+
+    legacyTextCopy(config.WIFI_SSID, legacy.WIFI_SSID);
+    legacyTextCopy(config.WIFI_PASSWORD, legacy.WIFI_PASSWORD);
+    legacyTextCopy(config.MQTT_HOST, legacy.MQTT_HOST);
+    if (legacy.MQTT_PORT > 0 && legacy.MQTT_PORT <= 0xFFFF) config.MQTT_PORT = legacy.MQTT_PORT;
+    legacyTextCopy(config.MQTT_USERNAME, legacy.MQTT_USERNAME);
+    legacyTextCopy(config.MQTT_PASSWORD, legacy.MQTT_PASSWORD);
+    legacyTextCopy(config.WQTT_TOKEN, legacy.WQTT_TOKEN);
+    // NaN не проходит ни одно сравнение и остаётся незаданной координатой.
+    if (fabsf(legacy.WEATHER_LATITUDE) <= 90 && fabsf(legacy.WEATHER_LONGITUDE) <= 180) {
+        config.WEATHER_LATITUDE = legacy.WEATHER_LATITUDE;
+        config.WEATHER_LONGITUDE = legacy.WEATHER_LONGITUDE;
+    }
+    configStore.save();
+    LOG_INFO(LOG_CONFIG_IMPORTED);
+}
+
 void loadConfig() {
-    EEPROM.begin(EEPROM_SIZE);
-    EEPROM.get(0, config);
-    EEPROM.end();
+    if (!configStore.load()) {
+        memset(&config, 0xFF, sizeof(config));
+        configImport();
+    }
 
-    if (config.WIFI_SSID[0] == 0xFF) config.WIFI_SSID[0] = '\0';
-    if (config.WIFI_PASSWORD[0] == 0xFF) config.WIFI_PASSWORD[0] = '\0';
+    // char бывает знаковым, поэтому байт стёртой памяти сравнивается как uint8_t.
+    if (static_cast<uint8_t>(config.WIFI_SSID[0]) == 0xFF) config.WIFI_SSID[0] = '\0';
+    if (static_cast<uint8_t>(config.WIFI_PASSWORD[0]) == 0xFF) config.WIFI_PASSWORD[0] = '\0';
 
-    if (config.MQTT_HOST[0] == 0xFF) config.MQTT_HOST[0] = '\0';
+    if (static_cast<uint8_t>(config.MQTT_HOST[0]) == 0xFF) config.MQTT_HOST[0] = '\0';
     if (config.MQTT_PORT == 0xFF) config.MQTT_PORT = 0;
-    if (config.MQTT_USERNAME[0] == 0xFF) config.MQTT_USERNAME[0] = '\0';
-    if (config.MQTT_PASSWORD[0] == 0xFF) config.MQTT_PASSWORD[0] = '\0';
-
-    if (config.DEVICE_ID == 0xFF) config.DEVICE_ID = 0;
-    if (config.WQTT_TOKEN[0] == 0xFF) config.WQTT_TOKEN[0] = '\0';
+    if (static_cast<uint8_t>(config.MQTT_USERNAME[0]) == 0xFF) config.MQTT_USERNAME[0] = '\0';
+    if (static_cast<uint8_t>(config.MQTT_PASSWORD[0]) == 0xFF) config.MQTT_PASSWORD[0] = '\0';
+
+    for (Node &node: config.NODES) {
+        if (node.addressLow != 0xFFFFFFFF) continue;
+        node.addressHigh = 0;
+        node.addressLow = 0;
+        node.DEVICE_ID = 0;
+        node.zones = 0;
+        node.legacy = false;
+        node.sleepy = false;
+    }
+    memcpy(nodes, config.NODES, sizeof(nodes));
+    if (static_cast<uint8_t>(config.WQTT_TOKEN[0]) == 0xFF) config.WQTT_TOKEN[0] = '\0';
 
     if (config.WEATHER_LATITUDE == 0xFF) config.WEATHER_LATITUDE = 0;
     if (config.WEATHER_LONGITUDE == 0xFF) config.WEATHER_LONGITUDE = 0;
 
-    Serial.println("Config loaded.");
-}
+    if (config.FORECAST.fetched == 0xFFFFFFFF) memset(&config.FORECAST, 0, sizeof(config.FORECAST));
 
-void saveConfig() {
-    EEPROM.begin(EEPROM_SIZE);
-    EEPROM.put(0, config);
-    EEPROM.commit();
-    EEPROM.end();
+    if (!networkStore.load()) memset(&network, 0, sizeof(network));
+    if (!shadowStore.load()) memset(shadowsStored, 0xFF, sizeof(shadowsStored));
+    memcpy(shadows, shadowsStored, sizeof(shadows));
+
+    LOG_INFO(LOG_CONFIG_LOADED);
 }
 
+void saveConfig() { configStore.save(); }
+
 void resetConfig() {
-    EEPROM.begin(EEPROM_SIZE);
-    for (int i = 0; i < EEPROM_SIZE; i++) {
-        EEPROM.write(i, 0xFF);
+    configStore.erase();
+    networkStore.erase();
+    shadowStore.erase();
+}
+
+/* Узлы */
+
+bool nodeEmpty(const Node &node) { return node.addressHigh == 0 && node.addressLow == 0; }
+
+Node *nodeFind(const XBeeAddress64 &address) {
+    for (Node &node: nodes) {
+        if (node.addressHigh == address.getMsb() && node.addressLow == address.getLsb()) return &node;
+    }
+    return nullptr;
+}
+
+Node *nodeFind(const char *id) {
+    char *end;
+    const unsigned long addressLow = strtoul(id, &end, 16);
+    if (end == id || *end != '\0') return nullptr;
+
+    for (Node &node: config.NODES) {
+        if (!nodeEmpty(node) && node.addressLow == addressLow) return &node;
+    }
+    return nullptr;
+}
+
+Node *nodeLearn(const XBeeAddress64 &address) {
+    Node *node = nodeFind(address);
+    if (node) return node;
+
+    for (Node &slot: nodes) {
+        if (!nodeEmpty(slot)) continue;
+        slot.addressHigh = address.getMsb();
+        slot.addressLow = address.getLsb();
+        slot.DEVICE_ID = 0;
+        slot.zones = 0;
+        slot.legacy = false;
+        slot.sleepy = false;
+        nodesSnapshot.publish(nodes);
+        memset(&shadows[&slot - nodes], 0xFF, sizeof(Shadow));
+        shadowsSnapshot.publish(shadows);
+
+        LOG_INFO(LOG_NODE_LEARNED, slot.addressLow);
+        return &slot;
+    }
+
+    LOG_ERROR(LOG_NODE_REGISTRY_FULL);
+    return nullptr;
+}
+
+NodeState &nodeState(const Node &node) { return nodeStates[&node - nodes]; }
+
+void nodeTopic(char *buffer, const size_t size, const Node &node, const char *topic) {
+    snprintf(buffer, size, MQTT_TOPIC_NODE, static_cast<unsigned long>(node.addressLow), topic);
+}
+
+void zoneTopic(char *buffer, const size_t size, const Node &node, const uint8_t zone, const char *topic) {
+    snprintf(buffer, size, MQTT_TOPIC_ZONE, static_cast<unsigned long>(node.addressLow), zone + 1, topic);
+}
+
+void nodeZones(Node &node, const uint8_t zones) {
+    if (node.zones != 0 || zones == 0) return;
+    node.zones = min(zones, ZONES_MAX);
+    nodesSnapshot.publish(nodes);
+}
+
+/* Тень настроек */
+
+constexpr int SHADOW_UNKNOWN = -1;
+
+Shadow &nodeShadow(const Node &node) { return shadows[&node - nodes]; }
+
+int shadowByte(const uint8_t value) { return value == 0xFF ? SHADOW_UNKNOWN : value; }
+
+int shadowGet(const Shadow &shadow, const Signal signal, const uint8_t zone) {
+    switch (signal) {
+        case SIGNAL_REFERENCE:
+            return shadowByte(shadow.reference[zone]);
+        case SIGNAL_MODE:
+            return shadowByte(shadow.mode[zone]);
+        case SIGNAL_LOOKAHEAD:
+            return shadowByte(shadow.lookahead);
+        case SIGNAL_DEADBAND:
+            return shadowByte(shadow.deadband);
+        case SIGNAL_HEARTBEAT:
+            return shadow.heartbeat == 0xFFFF ? SHADOW_UNKNOWN : shadow.heartbeat;
+        case SIGNAL_SLEEP:
+            return shadowByte(shadow.sleep);
+        default:
+            return SHADOW_UNKNOWN;
+    }
+}
+
+template<typename T>
+bool shadowAssign(T &field, const int16_t value) {
+    if (field == static_cast<T>(value)) return false;
+    field = value;
+    return true;
+}
+
+// Возвращает true, если значение изменилось и тень надо сохранить.
+bool shadowSet(Shadow &shadow, const Signal signal, const uint8_t zone, const int16_t value) {
+    switch (signal) {
+        case SIGNAL_REFERENCE:
+            return shadowAssign(shadow.reference[zone], value);
+        case SIGNAL_MODE:
+            return shadowAssign(shadow.mode[zone], value);
+        case SIGNAL_LOOKAHEAD:
+            return shadowAssign(shadow.lookahead, value);
+        case SIGNAL_DEADBAND:
+            return shadowAssign(shadow.deadband, value);
+        case SIGNAL_HEARTBEAT:
+            return shadowAssign(shadow.heartbeat, value);
+        case SIGNAL_SLEEP:
+            return shadowAssign(shadow.sleep, value);
+        default:
+            return false;
+    }
+}
+
+void stateTopic(char *buffer, const size_t size, const Node &node, const Signal signal, const uint8_t zone) {
+    const SignalSpec &spec = SIGNALS[signal];
+    spec.zoned ? zoneTopic(buffer, size, node, zone, spec.topic) : nodeTopic(buffer, size, node, spec.topic);
+    strlcat(buffer, MQTT_TOPIC_STATE, size);
+}
+
+/* Время */
+
+bool clockValid() { return time(nullptr) > CLOCK_VALID_AFTER; }
+
+Timestamp clockTimestamp() {
+    timeval now;
+    gettimeofday(&now, nullptr);
+    return {static_cast<uint32_t>(now.tv_sec), static_cast<uint16_t>(now.tv_usec / 1000)};
+}
+
+// Запасной путь, пока SNTP не ответил: время из ответа сервера прогнозов.
+void clockSet(const uint32_t now) {
+    if (clockValid()) return;
+    const timeval value = {static_cast<time_t>(now), 0};
+    settimeofday(&value, nullptr);
+}
+
+/* Прогноз */
+
+bool forecastValid() { return config.FORECAST.fetched != 0; }
+
+bool forecastFresh() {
+    return forecastValid() && clockValid() && time(nullptr) - config.FORECAST.fetched < WEATHER_INTERVAL / 1000;
+}
+
+bool forecastRain() {
+    for (const uint8_t rain: config.FORECAST.rain) if (rain > 0) return true;
+    return false;
+}
+
+/* Очередь MQTT */
+
+// Для показаний важно только последнее значение, поэтому новое заменяет ещё не отправленное;
+// история дописывается в конец. Записи истории уже подтверждены устройству, поэтому при переполнении
+// ничего не вытесняется: теряется новое сообщение, и потеря попадает в счётчик.
+void mqttPublish(const char *topic, const char *payload, const QueuePolicy policy, const unsigned long queued = 0) {
+    if (policy != QUEUE_APPEND) {
+        for (size_t i = outbound.size(); i > 0; i--) {
+            Outbound &waiting = outbound[i - 1];
+            if (strcmp(waiting.topic, topic) != 0) continue;
+            strlcpy(waiting.payload, payload, sizeof(waiting.payload));
+            waiting.queued = queued;
+            return;
+        }
+    }
+    if (outbound.full()) {
+        outboundDropped++;
+        return;
+    }
+
+    Outbound message;
+    strlcpy(message.topic, topic, sizeof(message.topic));
+    strlcpy(message.payload, payload, sizeof(message.payload));
+    message.queued = queued;
+    message.retained = policy == QUEUE_RETAINED;
+    outbound.push(message);
+}
+
+size_t outboundFree() { return outbound.capacity() - outbound.size(); }
+
+void outboundTask() {
+    // Из uplink берётся, только пока есть место: иначе показания вытеснили бы неотправленную историю,
+    // а так очередь радиозадачи заполняется, и устройства придерживают пачки до подтверждения.
+    while (!uplink.empty() && outboundFree() > 0) {
+        const Uplink &event = uplink.front();
+        mqttPublish(event.message.topic, event.message.payload, event.policy, event.message.queued);
+        uplink.pop();
+    }
+
+    for (unsigned int i = 0; i < MQTT_PUBLISH_BATCH && !outbound.empty() && mqttClient.connected(); i++) {
+        const Outbound &message = outbound.front();
+        if (!mqttClient.publish(message.topic, message.payload, message.retained)) {
+            metrics.mqttFailed++;
+            break;
+        }
+        metrics.mqttPublished++;
+        if (message.queued != 0) metrics.relay.record(millis() - message.queued);
+        outbound.pop();
     }
-    EEPROM.commit();
-    EEPROM.end();
 }
 
 /* ZigBee */
 
-void zbReceive(ZBRxResponse &rx, unsigned int) {
-    const int payloadLength = rx.getDataLength();
-    char payload[payloadLength + 1];
+void uplinkPublish(const char *topic, const char *payload, const QueuePolicy policy) {
+    Uplink event;
+    event.policy = policy;
+    strlcpy(event.message.topic, topic, sizeof(event.message.topic));
+    strlcpy(event.message.payload, payload, sizeof(event.message.payload));
+    event.message.queued = millis();
+    if (!uplink.push(event)) uplinkDropped++;
+}
+
+void publishNode(const Node &node, const char *topic, const int value) {
+    char topicBuffer[64];
+    char valueBuffer[12];
+    nodeTopic(topicBuffer, sizeof(topicBuffer), node, topic);
+    snprintf(valueBuffer, sizeof(valueBuffer), "%d", value);
+    uplinkPublish(topicBuffer, valueBuffer, QUEUE_LATEST);
+}
+
+void publishZone(const Node &node, const uint8_t zone, const char *topic, const int value) {
+    char topicBuffer[64];
+    char valueBuffer[12];
+    zoneTopic(topicBuffer, sizeof(topicBuffer), node, zone, topic);
+    snprintf(valueBuffer, sizeof(valueBuffer), "%d", value);
+    uplinkPublish(topicBuffer, valueBuffer, QUEUE_LATEST);
+}
+
+void publishSample(const Node &node, const Sample &sample, const uint8_t zones, const uint32_t time) {
+    char topic[64];
+    char payload[96];
+    nodeTopic(topic, sizeof(topic), node, MQTT_TOPIC_HISTORY);
+    int length = snprintf(payload, sizeof(payload), "%lu,%u,%u,%u", static_cast<unsigned long>(time), sample.seq,
+                          sample.water, sample.status);
+    for (uint8_t zone = 0; zone < zones; zone++) {
+        length += snprintf(payload + length, sizeof(payload) - length, ",%u", sample.moisture[zone]);
+    }
+    uplinkPublish(topic, payload, QUEUE_APPEND);
+}
+
+void publishLatest(const Node &node, const Sample &sample, const uint8_t zones) {
+    publishNode(node, SIGNALS[SIGNAL_WATER].topic, sample.water);
+    for (uint8_t zone = 0; zone < zones; zone++) {
+        publishZone(node, zone, SIGNALS[SIGNAL_VALUE].topic, sample.moisture[zone]);
+        publishZone(node, zone, SIGNALS[SIGNAL_STATUS].topic, (sample.status >> zone) & 1);
+    }
+}
+
+uint8_t zbSend(const Node &node, const void *data, uint8_t length);
+void linkSend(const Node &node, const void *data, uint8_t length);
+void linkAck(const Node &node, uint8_t seq);
+void linkResume(const Node &node);
+
+void publishCounters(const Node &node, const DeviceCounters &counters) {
+    publishNode(node, MQTT_TOPIC_FRAMES_IN, counters.framesIn);
+    publishNode(node, MQTT_TOPIC_FRAMES_OUT, counters.framesOut);
+    publishNode(node, MQTT_TOPIC_FRAMES_INVALID, counters.framesInvalid);
+    publishNode(node, MQTT_TOPIC_LOOP_MAX, counters.loopMax);
+}
+
+void zbReceiveTelemetry(Node &node, const TelemetryFrame &frame, const uint8_t length) {
+    const uint8_t count = min(frame.count, TELEMETRY_BATCH);
+    if (count == 0 || length < telemetryFrameSize(count)) return;
+    const uint8_t zones = min(frame.zones, ZONES_MAX);
+    nodeZones(node, zones);
+
+    // Без места под историю и последние значения пачка не подтверждается и остаётся в буфере устройства.
+    if (uplink.space() < count + 1u + 2u * zones + 4u) return;
+
+    NodeState &state = nodeState(node);
+    // Первая пачка после загрузки хаба задаёт отсчёт, какой бы ни была сессия, в том числе нулевая.
+    if (!state.sessionKnown || state.session != frame.session) {
+        state.session = frame.session;
+        state.sessionKnown = true;
+        state.sampleNext = frame.samples[0].seq;
+    }
+
+    // Синхронизированное устройство шлёт время замеров по часам хаба; иначе оно пересчитывается по возрасту замера.
+    const bool synced = frame.now >= TIME_EPOCH_MIN;
+    const uint32_t now = clockValid() ? time(nullptr) : 0;
+    const Sample *latest = nullptr;
+    for (uint8_t i = 0; i < count; i++) {
+        const Sample &sample = frame.samples[i];
+        if (seqBefore(sample.seq, state.sampleNext)) continue;
+        publishSample(node, sample, zones, synced ? sample.time : now > 0 ? now - (frame.now - sample.time) : 0);
+        state.sampleNext = sample.seq + 1;
+        latest = &sample;
+    }
+    if (latest) publishLatest(node, *latest, zones);
+    publishCounters(node, frame.counters);
+
+    const AckFrame ack = {frameHeaderOf(MESSAGE_ACK), frame.samples[0].seq, frame.samples[count - 1].seq};
+    zbSend(node, &ack, sizeof(ack));
+}
+
+void zbReceiveStats(const Node &node, const StatsFrame &frame) {
+    publishNode(node, MQTT_TOPIC_REPORTS_SENT, frame.reportsSent);
+    publishNode(node, MQTT_TOPIC_REPORTS_SUPPRESSED, frame.reportsSuppressed);
+    publishNode(node, MQTT_TOPIC_SAMPLES_DROPPED, frame.samplesDropped);
+    publishNode(node, MQTT_TOPIC_AWAKE, frame.awake);
+    publishNode(node, MQTT_TOPIC_ASLEEP, frame.asleep);
+    publishNode(node, MQTT_TOPIC_CONFIG_WRITES, frame.configWrites);
+    publishNode(node, MQTT_TOPIC_RADIO_FAILURES, frame.radioFailures);
+    publishNode(node, MQTT_TOPIC_LOG_WRITTEN, frame.logWritten);
+    publishNode(node, MQTT_TOPIC_LOG_DROPPED, frame.logDropped);
+}
+
+// Расходящиеся с желаемыми значения уходят одним кадром; неизвестные хабу желаемые значения не трогаются.
+void stateReconcile(const Node &node) {
+    const Shadow &desired = nodeShadow(node);
+    const Shadow &reported = nodeState(node).reported;
+    StateFrame diff = frameOf<StateFrame>(MESSAGE_STATE);
+    uint8_t count = 0;
+    for (const Signal signal: STATE_SIGNALS) {
+        const uint8_t zones = SIGNALS[signal].zoned ? node.zones : 1;
+        for (uint8_t zone = 0; zone < zones && count < STATE_DIFF_MAX; zone++) {
+            const int value = shadowGet(desired, signal, zone);
+            if (value == SHADOW_UNKNOWN || value == shadowGet(reported, signal, zone)) continue;
+            diff.entries[count++] = {signal, zone, static_cast<int16_t>(value)};
+        }
+    }
+    if (count == 0) return;
+    LOG_INFO(LOG_STATE_DIFF, node.addressLow, count);
+    linkSend(node, &diff, stateFrameSize(count));
+}
+
+// Отчёт обновляет тень и retained-топики состояния. Пока хаб не знает желаемого значения,
+// им становится значение устройства: после сброса хаба настройки узла не откатываются.
+void zbReceiveState(Node &node, const StateFrame &frame, const uint8_t length) {
+    const uint8_t count = min(stateFrameCount(length), STATE_ENTRIES_MAX);
+    if (uplink.space() < count) return;
+
+    // Узел, от которого ещё не было телеметрии, узнаёт число зон из отчёта.
+    uint8_t zones = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        const StateEntry &entry = frame.entries[i];
+        if (entry.signal < SIGNAL_COUNT && SIGNALS[entry.signal].zoned && entry.zone < ZONES_MAX) {
+            zones = max(zones, static_cast<uint8_t>(entry.zone + 1));
+        }
+    }
+    nodeZones(node, zones);
+
+    NodeState &state = nodeState(node);
+    Shadow &desired = nodeShadow(node);
+    bool learned = false;
+    for (uint8_t i = 0; i < count; i++) {
+        const StateEntry &entry = frame.entries[i];
+        if (entry.signal >= SIGNAL_COUNT || !signalIsState(entry.signal) || entry.zone >= ZONES_MAX) {
+            metrics.framesInvalid++;
+            continue;
+        }
+        if (SIGNALS[entry.signal].zoned && entry.zone >= node.zones) continue;
+
+        shadowSet(state.reported, entry.signal, entry.zone, entry.value);
+        if (shadowGet(desired, entry.signal, entry.zone) == SHADOW_UNKNOWN) {
+            learned |= shadowSet(desired, entry.signal, entry.zone, entry.value);
+        }
+
+        char topic[64];
+        char value[12];
+        stateTopic(topic, sizeof(topic), node, entry.signal, entry.zone);
+        snprintf(value, sizeof(value), "%d", entry.value);
+        uplinkPublish(topic, value, QUEUE_RETAINED);
+    }
+    if (learned) shadowsSnapshot.publish(shadows);
+    state.stateKnown = true;
+    stateReconcile(node);
+}
+
+// После загрузки хаба отчёта ещё нет: он запрашивается с первым кадром узла, а потерянный запрос повторяется.
+void stateRequest(const Node &node) {
+    NodeState &state = nodeState(node);
+    if (state.stateKnown) return;
+    if (state.stateRequested != 0 && !timerElapsed(state.stateRequested, STATE_REQUEST_INTERVAL)) return;
+    state.stateRequested = millis();
+    const FrameHeader request = frameHeaderOf(MESSAGE_STATE);
+    linkSend(node, &request, sizeof(request));
+}
+
+void zbReceiveWatering(const Node &node, const WateringFrame &frame) {
+    if (frame.zone >= node.zones) return;
+    publishZone(node, frame.zone, MQTT_TOPIC_WATERING_DURATION, frame.duration);
+    publishZone(node, frame.zone, MQTT_TOPIC_WATERING_VOLUME, static_cast<int>(frame.volume));
+    if (frame.time != 0) publishZone(node, frame.zone, MQTT_TOPIC_WATERING_TIME, static_cast<int>(frame.time));
+}
+
+// Ответ уходит сразу из радиозадачи, минуя очередь команд: время между received и sent устройство вычтет само,
+// а ожидание в очереди исказило бы задержку. Пока часы хаба не выставлены, запрос остаётся без ответа.
+void zbReceiveTime(const Node &node, const TimeFrame &frame) {
+    const Timestamp received = clockTimestamp();
+    if (frame.delay != 0xFFFF) {
+        publishNode(node, MQTT_TOPIC_TIME_DELAY, frame.delay);
+        publishNode(node, MQTT_TOPIC_TIME_ERROR, frame.error);
+        publishNode(node, MQTT_TOPIC_TIME_DRIFT, frame.drift);
+    }
+    if (!clockValid()) return;
+
+    TimeFrame reply = frame;
+    reply.received = received;
+    reply.sent = clockTimestamp();
+    zbSend(node, &reply, sizeof(reply));
+}
+
+void zbReceiveLegacy(Node &node, ZBRxResponse &rx) {
+    const uint8_t payloadLength = rx.getDataLength();
+    if (payloadLength > PROTOCOL_PAYLOAD_MAX) {
+        metrics.framesInvalid++;
+        return;
+    }
+    char payload[PROTOCOL_PAYLOAD_MAX + 1];
     memcpy(payload, rx.getData(), payloadLength);
     payload[payloadLength] = '\0';
 
-    Serial.print("ZigBee payload received: ");
-    Serial.println(payload);
-
     const char *command = strtok(payload, "=");
     const char *value = strtok(nullptr, "=");
-
-    if (strcmp(command, XBEE_COMMAND_VALUE) == 0) {
-        mqttClient.publish(MQTT_TOPIC_VALUE, value);
-    } else if (strcmp(command,  XBEE_COMMAND_STATUS) == 0) {
-        mqttClient.publish(MQTT_TOPIC_STATUS, value);
-    } else if (strcmp(command,  XBEE_COMMAND_WATER) == 0) {
-        mqttClient.publish(MQTT_TOPIC_WATER, value);
+    if (!command || !value) {
+        metrics.framesInvalid++;
+        return;
     }
+
+    nodeZones(node, 1);
+
+    const Signal signal = signalByLegacy(command);
+    LOG_DEBUG(LOG_ZB_LEGACY, node.addressLow, signal, atoi(value));
+    if (signal == SIGNAL_NONE || SIGNALS[signal].direction != SIGNAL_REPORT) return;
+
+    const SignalSpec &spec = SIGNALS[signal];
+    char topic[64];
+    spec.zoned ? zoneTopic(topic, sizeof(topic), node, 0, spec.topic) : nodeTopic(topic, sizeof(topic), node, spec.topic);
+    uplinkPublish(topic, value, QUEUE_LATEST);
 }
 
-void zbSend(const char *command, const char *value) {
-    const auto commandLength = strlen(command);
-    const auto valueLength = strlen(value);
-    const auto payloadLength = commandLength + valueLength + 1;
+void zbReceiveFrame(Node &node, const uint8_t *data, const uint8_t length) {
+    const FrameHeader *header = frameHeader(data, length);
+    if (!header) {
+        LOG_WARN(LOG_ZB_UNSUPPORTED);
+        metrics.framesInvalid++;
+        return;
+    }
+    LOG_DEBUG(LOG_ZB_FRAME, header->type, header->seq);
+
+    bool valid = true;
+    switch (header->type) {
+        case MESSAGE_LINK_ACK: {
+            const LinkAckFrame *frame = frameAs<LinkAckFrame>(data, length);
+            if ((valid = frame)) linkAck(node, frame->seq);
+            break;
+        }
+        case MESSAGE_TELEMETRY:
+            if ((valid = length >= telemetryFrameSize(0))) {
+                zbReceiveTelemetry(node, *reinterpret_cast<const TelemetryFrame *>(data), length);
+            }
+            break;
+        case MESSAGE_STATS: {
+            const StatsFrame *frame = frameAs<StatsFrame>(data, length);
+            if ((valid = frame)) zbReceiveStats(node, *frame);
+            break;
+        }
+        case MESSAGE_WATERING: {
+            const WateringFrame *frame = frameAs<WateringFrame>(data, length);
+            if ((valid = frame)) zbReceiveWatering(node, *frame);
+            break;
+        }
+        case MESSAGE_STATE:
+            if ((valid = length >= stateFrameSize(0))) {
+                zbReceiveState(node, *reinterpret_cast<const StateFrame *>(data), length);
+            }
+            break;
+        case MESSAGE_TIME: {
+            const TimeFrame *frame = frameAs<TimeFrame>(data, length);
+            if ((valid = frame)) zbReceiveTime(node, *frame);
+            break;
+        }
+        default:
+            break;
+    }
+    if (!valid) metrics.framesInvalid++;
+}
 
-    char buffer[payloadLength];
-    sprintf(buffer, "%s=%s", command, value);
-    const auto payload = reinterpret_cast<unsigned char *>(buffer);
+void zbReceive(ZBRxResponse &rx, uintptr_t) {
+    metrics.framesIn++;
+    Node *node = nodeLearn(rx.getRemoteAddress64());
+    if (!node) return;
+
+    const uint8_t *data = rx.getData();
+    const uint8_t length = rx.getDataLength();
+    const bool legacy = !frameIsCompatible(data, length);
+    if (node->legacy != legacy) {
+        node->legacy = legacy;
+        nodesSnapshot.publish(nodes);
+    }
+    if (legacy && frameIsBinary(data, length)) {
+        LOG_WARN(LOG_ZB_VERSION, length >= 2 ? data[1] : 0);
+        metrics.framesInvalid++;
+        return;
+    }
+    node->legacy ? zbReceiveLegacy(*node, rx) : zbReceiveFrame(*node, data, length);
+    if (node->legacy) return;
+    stateRequest(*node);
+    linkResume(*node);
+}
 
-    constexpr XBeeAddress64 address(0x00000000, 0x0000FFFF);
-    ZBTxRequest tx(address, payload, payloadLength);
+uint8_t zbSend(const Node &node, const void *data, const uint8_t length) {
+    const auto payload = static_cast<uint8_t *>(const_cast<void *>(data));
+    const XBeeAddress64 address(node.addressHigh, node.addressLow);
+    ZBTxRequest tx(address, payload, length);
+    tx.setFrameId(xbeeClient.getNextFrameId());
     xbeeClient.send(tx);
+    metrics.framesOut++;
+    return tx.getFrameId();
 }
 
-/* WiFi */
+/* Доставка команд */
+
+// Команды одного типа для одной зоны (прогноз — для всего узла) заменяют друг друга: важна только последняя.
+bool linkSameTarget(const Pending &a, const Pending &b) {
+    const auto headerA = reinterpret_cast<const FrameHeader *>(a.data);
+    const auto headerB = reinterpret_cast<const FrameHeader *>(b.data);
+    if (headerA->type != headerB->type) return false;
+    if (headerA->type == MESSAGE_FORECAST || headerA->type == MESSAGE_STATE || a.length <= sizeof(FrameHeader)) {
+        return true;
+    }
+    return a.data[sizeof(FrameHeader)] == b.data[sizeof(FrameHeader)];
+}
+
+void linkTransmit(const Node &node, Inflight &slot) {
+    slot.frameId = zbSend(node, slot.frame.data, slot.frame.length);
+    slot.sent = millis();
+}
+
+void linkPump(const Node &node) {
+    NodeState &state = nodeState(node);
+    for (Inflight &slot: state.inflight) {
+        if (state.outbox.empty()) return;
+        if (slot.seq != 0) continue;
+
+        slot.frame = state.outbox.front();
+        state.outbox.pop();
+        slot.seq = state.seqNext;
+        state.seqNext = state.seqNext == 0xFF ? 1 : state.seqNext + 1;
+        reinterpret_cast<FrameHeader *>(slot.frame.data)->seq = slot.seq;
+        slot.retries = 0;
+        slot.first = millis();
+        linkTransmit(node, slot);
+    }
+}
+
+// Кадр встаёт в очередь узла и уходит, как только в окне есть место; спящему узлу — когда он выйдет на связь.
+void linkSend(const Node &node, const void *data, const uint8_t length) {
+    Pending pending = {length, {}};
+    memcpy(pending.data, data, min(length, static_cast<uint8_t>(sizeof(pending.data))));
+
+    NodeState &state = nodeState(node);
+    for (Inflight &slot: state.inflight) {
+        if (slot.seq != 0 && linkSameTarget(slot.frame, pending)) slot.seq = 0;
+    }
+
+    bool replaced = false;
+    for (size_t i = 0; i < state.outbox.size() && !replaced; i++) {
+        if (!linkSameTarget(state.outbox[i], pending)) continue;
+        state.outbox[i] = pending;
+        replaced = true;
+    }
+    if (!replaced && !state.outbox.push(pending)) LOG_WARN(LOG_PENDING_DROPPED, node.addressLow);
+
+    if (!node.sleepy) linkPump(node);
+}
+
+void linkAck(const Node &node, const uint8_t seq) {
+    NodeState &state = nodeState(node);
+    for (Inflight &slot: state.inflight) {
+        if (seq == 0 || slot.seq != seq) continue;
+        const unsigned long latency = millis() - slot.first;
+        state.link.delivered++;
+        state.link.latencyTotal += latency;
+        state.link.latencyMax = max(state.link.latencyMax, static_cast<uint32_t>(latency));
+        slot.seq = 0;
+    }
+    linkPump(node);
+}
 
-bool wifiConnect() {
-    Serial.print("Connecting to WiFi network...");
-    WiFi.begin(config.WIFI_SSID, config.WIFI_PASSWORD);
-    for (unsigned int i = 0; i < 10; i++) {
-        if (WiFiClass::status() == WL_CONNECTED) {
-            Serial.println("connected");
-            return true;
+void linkDrop(const Node &node, NodeState &state, Inflight &slot) {
+    LOG_WARN(LOG_COMMAND_NOT_DELIVERED, slot.seq, node.addressLow);
+    state.link.failed++;
+    slot.seq = 0;
+}
+
+void linkRetry(const Node &node, NodeState &state, Inflight &slot) {
+    if (slot.retries >= LINK_RETRIES) {
+        linkDrop(node, state, slot);
+        return;
+    }
+    slot.retries++;
+    state.link.retries++;
+    linkTransmit(node, slot);
+}
+
+// Спящий узел выходит на связь не реже раза за heartbeat: команда, не подтверждённая за LINK_RETRIES + 1
+// таких периодов, считается потерянной. Пока отчёта о настройках нет, берётся наибольший heartbeat.
+unsigned long linkSleepyTimeout(const NodeState &state) {
+    const bool known = state.stateKnown && state.reported.heartbeat != 0xFFFF;
+    const unsigned long heartbeat = known ? state.reported.heartbeat : SIGNALS[SIGNAL_HEARTBEAT].max;
+    return (LINK_RETRIES + 1ul) * heartbeat * 60000ul;
+}
+
+// Узел на связи. Спящему кадры, ждавшие пробуждения, повторяются один раз за пробуждение —
+// на первом кадре после паузы дольше LINK_AWAKE_WINDOW, — и каждый такой повтор считается попыткой.
+void linkResume(const Node &node) {
+    NodeState &state = nodeState(node);
+    const bool woke = timerElapsed(state.heard, LINK_AWAKE_WINDOW);
+    state.heard = millis();
+    if (node.sleepy && woke) {
+        for (Inflight &slot: state.inflight) {
+            if (slot.seq != 0) linkRetry(node, state, slot);
         }
-        Serial.print(".");
-        delay(1000);
     }
-    Serial.println("not connected");
-    return false;
+    linkPump(node);
+}
+
+// Пока спящий узел не слушает эфир, повторять ему бесполезно: повторы ведёт linkResume,
+// а здесь снимаются команды, которые он так и не подтвердил.
+void linkTimeouts(const Node &node) {
+    NodeState &state = nodeState(node);
+    const bool asleep = node.sleepy && timerElapsed(state.heard, LINK_AWAKE_WINDOW);
+    for (Inflight &slot: state.inflight) {
+        if (slot.seq == 0) continue;
+        if (asleep) {
+            if (timerElapsed(slot.sent, linkSleepyTimeout(state))) linkDrop(node, state, slot);
+            continue;
+        }
+        if (timerElapsed(slot.sent, LINK_TIMEOUT)) linkRetry(node, state, slot);
+    }
+    if (!asleep) linkPump(node);
+}
+
+// Отказ доставки на уровне радио не ждёт таймаута: кадр повторяется на следующем проходе linkTask.
+void zbTxStatus(ZBTxStatusResponse &status, uintptr_t) {
+    if (status.isSuccess()) return;
+    for (const Node &node: nodes) {
+        if (nodeEmpty(node)) continue;
+        NodeState &state = nodeState(node);
+        for (Inflight &slot: state.inflight) {
+            if (slot.seq == 0 || slot.frameId != status.getFrameId()) continue;
+            state.link.txFailures++;
+            slot.sent = millis() - LINK_TIMEOUT;
+            return;
+        }
+    }
+}
+
+void downlinkPush(const Node &node, Downlink &command) {
+    command.node = &node - config.NODES;
+    if (downlink.push(command)) return;
+    downlinkDropped++;
+    LOG_WARN(LOG_DOWNLINK_DROPPED, node.addressLow);
+}
+
+// Команды сетевой задачи не трогают радио: кадр уходит в downlink, а отправку и повторы ведёт радиозадача.
+void downlinkSend(const Node &node, const void *data, const uint8_t length, const bool legacy) {
+    Downlink command;
+    command.type = legacy ? DOWNLINK_LEGACY : DOWNLINK_FRAME;
+    command.frame.length = min(length, static_cast<uint8_t>(sizeof(command.frame.data)));
+    memcpy(command.frame.data, data, command.frame.length);
+    downlinkPush(node, command);
+}
+
+void downlinkNode(const Node &node, const DownlinkType type, const int32_t value) {
+    Downlink command;
+    command.type = type;
+    command.value = value;
+    downlinkPush(node, command);
+}
+
+void downlinkDesired(const Node &node, const Signal signal, const uint8_t zone, const int16_t value) {
+    Downlink command;
+    command.type = DOWNLINK_DESIRED;
+    command.signal = signal;
+    command.zone = zone;
+    command.value = value;
+    downlinkPush(node, command);
+}
+
+void downlinkTask() {
+    while (!downlink.empty()) {
+        const Downlink &command = downlink.front();
+        Node &node = nodes[command.node];
+        switch (command.type) {
+            case DOWNLINK_FRAME:
+                linkSend(node, command.frame.data, command.frame.length);
+                break;
+            case DOWNLINK_LEGACY:
+                zbSend(node, command.frame.data, command.frame.length);
+                break;
+            case DOWNLINK_DESIRED: {
+                const auto signal = static_cast<Signal>(command.signal);
+                if (shadowSet(nodeShadow(node), signal, command.zone, command.value)) shadowsSnapshot.publish(shadows);
+                break;
+            }
+            case DOWNLINK_DEVICE_ID:
+                node.DEVICE_ID = command.value;
+                nodesSnapshot.publish(nodes);
+                break;
+            case DOWNLINK_SLEEPY:
+                // Приходит после команды сна: узел, который ещё не спит, получил её сразу, а спящий получит при пробуждении.
+                node.sleepy = command.value != 0;
+                nodesSnapshot.publish(nodes);
+                break;
+        }
+        downlink.pop();
+    }
+}
+
+void zbSendLegacy(const Node &node, const char *command, const int value) {
+    char buffer[sizeof(Pending::data)];
+    const int payloadLength = snprintf(buffer, sizeof(buffer), "%s=%d", command, value);
+    downlinkSend(node, buffer, min(payloadLength, static_cast<int>(sizeof(buffer) - 1)), true);
+}
+
+void zbSendCommand(const Node &node, const MessageType type, const uint8_t zone, const int16_t value) {
+    if (node.legacy) {
+        const Signal signal = signalByType(type);
+        if (signal != SIGNAL_NONE && SIGNALS[signal].legacy) zbSendLegacy(node, SIGNALS[signal].legacy, value);
+        return;
+    }
+
+    const CommandFrame frame = {frameHeaderOf(type), zone, value};
+    downlinkSend(node, &frame, sizeof(frame), false);
+}
+
+void zbSendCalibration(const Node &node, const uint8_t zone, const char *value) {
+    if (node.legacy) return;
+
+    int dry = CALIBRATION_KEEP;
+    int wet = CALIBRATION_KEEP;
+    if (strcmp(value, "dry") == 0) {
+        dry = CALIBRATION_CURRENT;
+    } else if (strcmp(value, "wet") == 0) {
+        wet = CALIBRATION_CURRENT;
+    } else if (sscanf(value, "%d,%d", &dry, &wet) != 2) {
+        return;
+    }
+
+    const CalibrationFrame frame = {
+        frameHeaderOf(MESSAGE_CALIBRATION),
+        zone,
+        static_cast<int16_t>(dry),
+        static_cast<int16_t>(wet),
+    };
+    downlinkSend(node, &frame, sizeof(frame), false);
+}
+
+void zbSendForecast(const Node &node) {
+    if (node.legacy) {
+        zbSendCommand(node, MESSAGE_RAIN, 0, forecastRain() ? 1 : 0);
+        return;
+    }
+
+    ForecastFrame frame = frameOf<ForecastFrame>(MESSAGE_FORECAST);
+    frame.time = config.FORECAST.time;
+    frame.now = clockValid() ? time(nullptr) : config.FORECAST.fetched;
+    memcpy(frame.rain, config.FORECAST.rain, sizeof(frame.rain));
+    downlinkSend(node, &frame, sizeof(frame), false);
+}
+
+void zbSendForecastAll() {
+    for (const Node &node: config.NODES) {
+        if (!nodeEmpty(node)) zbSendForecast(node);
+    }
+}
+
+/* WiFi */
+
+void connectFailed();
+
+uint16_t networkSsid() { return crc16(config.WIFI_SSID, strlen(config.WIFI_SSID)); }
+
+// Без DHCP прежний адрес занимается, только пока его аренда заведомо не истекла. Срок отсчитывается по часам хаба,
+// поэтому после холодного старта, пока часов нет, адрес берётся у DHCP.
+bool networkLeased() {
+    return network.leased != 0 && clockValid() && time(nullptr) - network.leased < WIFI_LEASE_TIME / 1000;
+}
+
+// Канал и BSSID годятся и без часов: после сбоя питания хаб всё равно подключается без сканирования.
+bool networkCached() { return network.channel != 0 && network.ssid == networkSsid(); }
+
+// Параметры пишутся, только когда сменились; после DHCP меняется и время аренды, но быстрый старт записи не делает.
+void networkRemember() {
+    Network current;
+    memset(&current, 0, sizeof(current));
+    current.ssid = networkSsid();
+    current.channel = WiFi.channel();
+    memcpy(current.bssid, WiFi.BSSID(), sizeof(current.bssid));
+    current.ip = WiFi.localIP();
+    current.gateway = WiFi.gatewayIP();
+    current.subnet = WiFi.subnetMask();
+    current.dns = WiFi.dnsIP();
+    current.leased = wifiStatic ? network.leased : clockValid() ? time(nullptr) : 0;
+    if (memcmp(&current, &network, sizeof(network)) == 0) return;
+
+    network = current;
+    networkStore.save();
+}
+
+void networkForget() {
+    network.channel = 0;
+    networkStore.save();
+}
+
+void wifiTask() {
+    switch (wifiState) {
+        case WIFI_IDLE:
+            wifiFast = networkCached();
+            wifiStatic = wifiFast && networkLeased();
+            if (wifiFast) {
+                // Без сканирования: сразу к известной точке на её канале, а пока аренда не истекла — и без DHCP.
+                LOG_INFO(LOG_WIFI_CONNECTING_CACHED, network.channel);
+                if (wifiStatic) {
+                    WiFi.config(IPAddress(network.ip), IPAddress(network.gateway), IPAddress(network.subnet),
+                                IPAddress(network.dns));
+                } else {
+                    WiFi.config(IPAddress(), IPAddress(), IPAddress());
+                }
+                WiFi.begin(config.WIFI_SSID, config.WIFI_PASSWORD, network.channel, network.bssid);
+            } else {
+                LOG_INFO(LOG_WIFI_CONNECTING);
+                // Нулевые адреса возвращают DHCP после неудачного быстрого подключения.
+                WiFi.config(IPAddress(), IPAddress(), IPAddress());
+                WiFi.begin(config.WIFI_SSID, config.WIFI_PASSWORD);
+            }
+            wifiLast = millis();
+            wifiState = WIFI_CONNECTING;
+            break;
+        case WIFI_CONNECTING:
+            if (WiFiClass::status() == WL_CONNECTED) {
+                const IPAddress ip = WiFi.localIP();
+                LOG_INFO(LOG_WIFI_CONNECTED, ip[0], ip[1], ip[2], ip[3]);
+                if (bootWifi == 0) {
+                    bootWifi = millis();
+                    bootFast = wifiFast;
+                }
+                networkRemember();
+                // SNTP дальше сам сверяет часы раз в час; устройства получают время уже от хаба.
+                configTime(0, 0, TIME_SERVER_PRIMARY, TIME_SERVER_SECONDARY);
+                wifiState = WIFI_CONNECTED;
+            } else if (timerElapsed(wifiLast, !wifiFast ? WIFI_TIMEOUT : wifiStatic ? WIFI_FAST_TIMEOUT : WIFI_FAST_DHCP_TIMEOUT)) {
+                LOG_WARN(LOG_WIFI_NOT_CONNECTED);
+                wifiLast = millis();
+                wifiState = WIFI_FAILED;
+                connectFailed();
+            }
+            break;
+        case WIFI_CONNECTED:
+            if (WiFiClass::status() != WL_CONNECTED) {
+                LOG_WARN(LOG_WIFI_LOST);
+                wifiState = WIFI_IDLE;
+                mqttState = MQTT_IDLE;
+            } else if (wifiStatic && !networkLeased()) {
+                // Адрес занят без DHCP, и аренду никто не продлевал: переподключаемся обычным путём, пока он не достался другому.
+                LOG_INFO(LOG_WIFI_LEASE_EXPIRED);
+                WiFi.disconnect();
+                wifiState = WIFI_IDLE;
+                mqttState = MQTT_IDLE;
+            } else if (!wifiStatic && network.leased == 0 && clockValid()) {
+                // После холодного старта часы появляются уже после подключения.
+                network.leased = time(nullptr);
+                networkStore.save();
+            }
+            break;
+        case WIFI_FAILED:
+            if (timerElapsed(wifiLast, RECONNECT_INTERVAL)) wifiState = WIFI_IDLE;
+            break;
+    }
 }
 
 void wifiShare() {
     WiFi.disconnect();
     WiFi.softAP(WIFI_SSID, WIFI_PASSWORD);
-    Serial.print("WiFi host is started on ");
-    Serial.println(WiFi.softAPIP());
+    const IPAddress ip = WiFi.softAPIP();
+    LOG_INFO(LOG_WIFI_HOST, ip[0], ip[1], ip[2], ip[3]);
 }
 
 /* API */
 
-int registerDevice() {
-    Serial.print("Registering device...");
+void httpsSetup(HttpsOrigin &origin) {
+    origin.client.setCACert(HTTPS_CA_BUNDLE);
+    origin.client.setHandshakeTimeout(HTTP_TIMEOUT / 1000);
+    origin.http.setConnectTimeout(HTTP_TIMEOUT);
+    origin.http.setTimeout(HTTP_TIMEOUT);
+    // HTTP/1.0 отключает chunked-ответы, и JSON можно разбирать прямо из потока;
+    // с setReuse сервер всё равно получает Connection: keep-alive и не закрывает соединение.
+    origin.http.useHTTP10(true);
+    origin.http.setReuse(true);
+}
+
+// Рукопожатие TLS нужно, только если прошлое соединение с этим сервером уже закрыто.
+// Запрос целиком выполняется в тике сетевой задачи, и каждый его шаг ограничен HTTP_TIMEOUT.
+bool httpsBegin(HttpsOrigin &origin, const char *url) {
+    httpsRequests++;
+    if (!origin.client.connected()) httpsHandshakes++;
+    if (origin.http.begin(origin.client, url)) return true;
+    metrics.httpsFailed++;
+    return false;
+}
+
+// Любой ответ, кроме 200, закрывает запрос и считается отказом наравне с обрывом и битым JSON.
+bool httpsStatus(HTTPClient &http, const int code) {
+    if (code == 200) return true;
+    http.end();
+    metrics.httpsFailed++;
+    return false;
+}
+
+void httpAuthorize(HTTPClient &http) {
+    char authorization[sizeof("Token ") + sizeof(config.WQTT_TOKEN)];
+    snprintf(authorization, sizeof(authorization), "Token %s", config.WQTT_TOKEN);
+    http.addHeader("Authorization", authorization);
+    http.addHeader("Accept", "*/*");
+}
 
-    JsonDocument docRequest;
+bool httpReadJson(HTTPClient &http, JsonDocument &doc, const JsonDocument &filter) {
+    const DeserializationError error = deserializeJson(doc, http.getStream(), DeserializationOption::Filter(filter));
+    http.end();
+    if (error) metrics.httpsFailed++;
+    return !error;
+}
+
+int registerDevice(Node &node) {
+    LOG_INFO(LOG_DEVICE_REGISTERING, node.addressLow);
+
+    char topic[64];
+    jsonArena.reset();
+    JsonDocument docRequest(&jsonArena);
     docRequest["name"] = "Полив";
     docRequest["type"] = 19;
     docRequest["room"] = "Сад";
     const JsonArray sensors_float = docRequest["sensors_float"].to<JsonArray>();
-    const JsonObject sensor1 = sensors_float.add<JsonObject>();
-    sensor1["type"] = 1;
-    sensor1["topic"] = "moisture/value";
-    sensor1["multiplier"] = 1;
-    const JsonObject sensor2 = sensors_float.add<JsonObject>();
-    sensor2["type"] = 7;
-    sensor2["topic"] = "water/level";
-    sensor2["multiplier"] = 1;
     const JsonArray sensors_event = docRequest["sensors_event"].to<JsonArray>();
-    const JsonObject sensor = sensors_event.add<JsonObject>();
-    sensor["type"] = 5;
-    sensor["topic"] = "watering/status";
     const JsonArray range = docRequest["range"].to<JsonArray>();
-    const JsonObject range1 = range.add<JsonObject>();
-    range1["type"] = 2;
-    range1["topic_cmd"] = "moisture/reference";
-    range1["topic_state"] = "";
-    range1["max"] = 100;
-    range1["min"] = 0;
-    range1["precision"] = 1;
-    range1["multiplier"] = 1;
     const JsonArray mode = docRequest["mode"].to<JsonArray>();
-    const JsonObject mode1 = mode.add<JsonObject>();
-    mode1["type"] = 6;
-    mode1["topic_cmd"] = "watering/mode";
-    mode1["topic_state"] = "";
-    mode1["options"] = "one=1,two=2,three=3";
-    String requestBody;
-    serializeJson(docRequest, requestBody);
-
-    if (!httpClient.begin(clientSecure, ENDPOINT_DEVICE_REGISTER)) return 0;
-    httpClient.addHeader("Authorization", "Token " + String(config.WQTT_TOKEN));
-    httpClient.addHeader("Accept", "*/*");
-    httpClient.addHeader("Content-Type", "application/json");
-    if (httpClient.POST(requestBody) != 200) return 0;
-
-    String payload = httpClient.getString();
-    httpClient.end();
-
-    JsonDocument docResponse;
-    const DeserializationError error = deserializeJson(docResponse, payload);
-    if (error) return 0;
-
-    config.DEVICE_ID = docResponse["detail"]["device_id"];
+    for (uint8_t zone = 0; zone < node.zones; zone++) {
+        const JsonObject sensorValue = sensors_float.add<JsonObject>();
+        sensorValue["type"] = 1;
+        zoneTopic(topic, sizeof(topic), node, zone, SIGNALS[SIGNAL_VALUE].topic);
+        sensorValue["topic"] = topic;
+        sensorValue["multiplier"] = 1;
+        const JsonObject sensorStatus = sensors_event.add<JsonObject>();
+        sensorStatus["type"] = 5;
+        zoneTopic(topic, sizeof(topic), node, zone, SIGNALS[SIGNAL_STATUS].topic);
+        sensorStatus["topic"] = topic;
+        const JsonObject rangeReference = range.add<JsonObject>();
+        rangeReference["type"] = 2;
+        zoneTopic(topic, sizeof(topic), node, zone, SIGNALS[SIGNAL_REFERENCE].topic);
+        rangeReference["topic_cmd"] = topic;
+        stateTopic(topic, sizeof(topic), node, SIGNAL_REFERENCE, zone);
+        rangeReference["topic_state"] = topic;
+        rangeReference["max"] = SIGNALS[SIGNAL_REFERENCE].max;
+        rangeReference["min"] = SIGNALS[SIGNAL_REFERENCE].min;
+        rangeReference["precision"] = 1;
+        rangeReference["multiplier"] = 1;
+        const JsonObject modeZone = mode.add<JsonObject>();
+        modeZone["type"] = 6;
+        zoneTopic(topic, sizeof(topic), node, zone, SIGNALS[SIGNAL_MODE].topic);
+        modeZone["topic_cmd"] = topic;
+        stateTopic(topic, sizeof(topic), node, SIGNAL_MODE, zone);
+        modeZone["topic_state"] = topic;
+        modeZone["options"] = "one=1,two=2,three=3";
+    }
+    const JsonObject sensorWater = sensors_float.add<JsonObject>();
+    sensorWater["type"] = 7;
+    nodeTopic(topic, sizeof(topic), node, SIGNALS[SIGNAL_WATER].topic);
+    sensorWater["topic"] = topic;
+    sensorWater["multiplier"] = 1;
+    const size_t bodyLength = measureJson(docRequest);
+    if (bodyLength >= sizeof(httpBody)) return 0;
+    serializeJson(docRequest, httpBody, sizeof(httpBody));
+
+    HTTPClient &http = wqttOrigin.http;
+    if (!httpsBegin(wqttOrigin, ENDPOINT_DEVICE_REGISTER)) return 0;
+    httpAuthorize(http);
+    http.addHeader("Content-Type", "application/json");
+    if (!httpsStatus(http, http.POST(reinterpret_cast<uint8_t *>(httpBody), bodyLength))) return 0;
+
+    JsonDocument filter(&jsonArena);
+    filter["detail"]["device_id"] = true;
+
+    JsonDocument docResponse(&jsonArena);
+    if (!httpReadJson(http, docResponse, filter)) return 0;
+
+    // Своя копия меняется сразу, чтобы узел не регистрировался повторно; таблицу радиозадачи правит downlink.
+    node.DEVICE_ID = docResponse["detail"]["device_id"];
+    downlinkNode(node, DOWNLINK_DEVICE_ID, node.DEVICE_ID);
     saveConfig();
 
-    Serial.println(config.DEVICE_ID);
-    return config.DEVICE_ID;
+    LOG_INFO(LOG_DEVICE_REGISTERED, node.addressLow, node.DEVICE_ID);
+    return node.DEVICE_ID;
+}
+
+void registerNodes() {
+    for (Node &node: config.NODES) {
+        if (nodeEmpty(node) || node.zones == 0 || node.DEVICE_ID > 0) continue;
+        if (registerDevice(node) == 0) return;
+    }
 }
 
 bool updateBroker() {
-    Serial.print("Fetching broker data...");
+    LOG_INFO(LOG_BROKER_FETCHING);
 
-    if (!httpClient.begin(clientSecure, ENDPOINT_DEVICE_CONNECT)) return false;
-    httpClient.addHeader("Authorization", "Token " + String(config.WQTT_TOKEN));
-    httpClient.addHeader("Accept", "*/*");
-    if (httpClient.GET() != 200) return false;
+    HTTPClient &http = wqttOrigin.http;
+    if (!httpsBegin(wqttOrigin, ENDPOINT_DEVICE_CONNECT)) return false;
+    httpAuthorize(http);
+    if (!httpsStatus(http, http.GET())) return false;
 
-    String payload = httpClient.getString();
-    httpClient.end();
+    jsonArena.reset();
+    JsonDocument filter(&jsonArena);
+    filter["server"] = true;
+    filter["port"] = true;
+    filter["user"] = true;
+    filter["password"] = true;
 
-    JsonDocument docResponse;
-    const DeserializationError error = deserializeJson(docResponse, payload);
-    if (error) return false;
+    JsonDocument docResponse(&jsonArena);
+    if (!httpReadJson(http, docResponse, filter)) return false;
 
     strcpy(config.MQTT_HOST, docResponse["server"]);
     config.MQTT_HOST[sizeof(config.MQTT_HOST) - 1] = '\0';
@@ -213,46 +1231,89 @@ bool updateBroker() {
     config.MQTT_PASSWORD[sizeof(config.MQTT_PASSWORD) - 1] = '\0';
 
     saveConfig();
-    Serial.println("done.");
+    LOG_INFO(LOG_BROKER_FETCHED);
     return true;
 }
 
-bool willRainToday() {
+bool forecastFetch() {
     if (config.WEATHER_LATITUDE <= 0) return false;
     if (config.WEATHER_LONGITUDE <= 0) return false;
 
-    String endpoint = ENDPOINT_WEATHER;
-    endpoint.replace("%lat%", String(config.WEATHER_LATITUDE));
-    endpoint.replace("%lon%", String(config.WEATHER_LONGITUDE));
+    char endpoint[sizeof(ENDPOINT_WEATHER) + 16];
+    snprintf(endpoint, sizeof(endpoint), ENDPOINT_WEATHER, config.WEATHER_LATITUDE, config.WEATHER_LONGITUDE);
 
-    if (!httpClient.begin(clientSecure, endpoint)) return false;
-    const int httpCode = httpClient.GET();
-    if (httpCode != 200) return false;
+    HTTPClient &http = weatherOrigin.http;
+    if (!httpsBegin(weatherOrigin, endpoint)) return false;
+    if (!httpsStatus(http, http.GET())) return false;
 
-    String payload = httpClient.getString();
-    httpClient.end();
+    jsonArena.reset();
+    JsonDocument filter(&jsonArena);
+    filter["current"]["time"] = true;
+    filter["hourly"]["time"] = true;
+    filter["hourly"]["rain"] = true;
 
-    JsonDocument docResponse;
-    const DeserializationError error = deserializeJson(docResponse, payload);
-    if (error) return false;
+    JsonDocument docResponse(&jsonArena);
+    if (!httpReadJson(http, docResponse, filter)) return false;
 
+    const uint32_t current = docResponse["current"]["time"];
+    const uint32_t start = docResponse["hourly"]["time"][0];
     const auto hourlyRain = docResponse["hourly"]["rain"].as<JsonArray>();
-    for (JsonVariant mm: hourlyRain) if (mm.as<float>() > 0.0f) return true;
-    return false;
+    if (current == 0 || start == 0 || hourlyRain.size() == 0) return false;
+
+    Forecast &forecast = config.FORECAST;
+    forecast.time = start;
+    forecast.fetched = current;
+    memset(forecast.rain, 0, sizeof(forecast.rain));
+    uint8_t hour = 0;
+    for (JsonVariant mm: hourlyRain) {
+        if (hour >= FORECAST_HOURS) break;
+        forecast.rain[hour++] = static_cast<uint8_t>(constrain(lroundf(mm.as<float>() * 10.0f), 0l, 255l));
+    }
+
+    clockSet(current);
+    saveConfig();
+    return true;
 }
 
 /* Сервер */
 
-void handleGet() {
-    String content = FPSTR(HTML_PAGE_INDEX);
+void sendText(const char *text) { webServer.sendContent(text, strlen(text)); }
+
+void sendField(const PageField field) {
+    char buffer[16];
+    switch (field) {
+        case PAGE_FIELD_SSID_VAL: sendText(config.WIFI_SSID); break;
+        case PAGE_FIELD_PASS_VAL: sendText(config.WIFI_PASSWORD); break;
+        case PAGE_FIELD_WQTT_TOKEN_VAL: sendText(config.WQTT_TOKEN); break;
+        case PAGE_FIELD_LATITUDE_VAL:
+            snprintf(buffer, sizeof(buffer), "%.6f", config.WEATHER_LATITUDE);
+            sendText(buffer);
+            break;
+        case PAGE_FIELD_LONGITUDE_VAL:
+            snprintf(buffer, sizeof(buffer), "%.6f", config.WEATHER_LONGITUDE);
+            sendText(buffer);
+            break;
+        default:
+            break;
+    }
+}
 
-    content.replace("%SSID_VAL%", config.WIFI_SSID);
-    content.replace("%PASS_VAL%", config.WIFI_PASSWORD);
-    content.replace("%WQTT_TOKEN_VAL%", config.WQTT_TOKEN);
-    content.replace("%LATITUDE_VAL%", String(config.WEATHER_LATITUDE));
-    content.replace("%LONGITUDE_VAL%", String(config.WEATHER_LONGITUDE));
+// Страница уходит chunked-ответом: сегменты из флеша и значения полей между ними, без копии в куче.
+void handleGet() {
+    webServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    webServer.send(200, "text/html", "");
+    for (const PageSegment &segment: PAGE_INDEX) {
+        webServer.sendContent_P(segment.text);
+        sendField(segment.field);
+    }
+    webServer.sendContent("", 0);
+}
 
-    webServer.send(200, "text/html", content);
+// Ассеты сжаты при сборке и не меняются до перепрошивки, поэтому браузер может их кешировать.
+void handleAsset(const Asset &asset) {
+    webServer.sendHeader("Content-Encoding", "gzip");
+    webServer.sendHeader("Cache-Control", "max-age=86400");
+    webServer.send_P(200, asset.type, reinterpret_cast<const char *>(asset.data), asset.size);
 }
 
 void handlePost() {
@@ -282,10 +1343,14 @@ void handlePost() {
 void handleReset() {
     resetConfig();
     webServer.send(200, "text/plain", "Config reset. Restart in 3 seconds...");
-    delay(3000);
-    ESP.restart();
+    restartLast = millis();
+    restartPending = true;
 }
 
+const char *metricsSnapshot();
+
+void handleMetrics() { webServer.send(200, "application/json", metricsSnapshot()); }
+
 void handle404() {
     webServer.sendHeader("Location", String("http://") + WiFi.softAPIP().toString(), true);
     webServer.send(302, "text/plain", "");
@@ -295,47 +1360,344 @@ void setupServer() {
     webServer.on("/", HTTP_GET, handleGet);
     webServer.on("/", HTTP_POST, handlePost);
     webServer.on("/reset", HTTP_POST, handleReset);
+    webServer.on("/metrics", HTTP_GET, handleMetrics);
+    for (const Asset &asset: ASSETS) webServer.on(asset.path, HTTP_GET, [&asset] { handleAsset(asset); });
     webServer.onNotFound(handle404);
     webServer.begin();
 }
 
 /* MQTT */
 
-bool mqttConnect() {
-    mqttClient.setServer(config.MQTT_HOST, config.MQTT_PORT);
-    if (strlen(config.MQTT_HOST) == 0 && !updateBroker()) return false;
-    if (config.DEVICE_ID <= 0 && registerDevice() == 0) return false;
-
-    Serial.print("Connecting to MQTT broker...");
-    for (unsigned int i = 0; i < 10; i++) {
-        if (mqttClient.connect(WiFi.macAddress().c_str(), config.MQTT_USERNAME, config.MQTT_PASSWORD)) {
-            Serial.println("connected");
-            mqttClient.subscribe(MQTT_TOPIC_REFERENCE);
-            mqttClient.subscribe(MQTT_TOPIC_MODE);
-            return true;
-        }
-        Serial.print(".");
-        delay(1000);
+void mqttSubscribe() {
+    char topic[64];
+    for (const SignalSpec &spec: SIGNALS) {
+        if (spec.direction != SIGNAL_COMMAND || !spec.topic) continue;
+        snprintf(topic, sizeof(topic), spec.zoned ? MQTT_TOPIC_ZONE_ANY : MQTT_TOPIC_NODE_ANY, spec.topic);
+        mqttClient.subscribe(topic, MQTT_SUBSCRIBE_QOS);
+    }
+}
+
+void bootReport();
+
+void mqttTask() {
+    switch (mqttState) {
+        case MQTT_IDLE:
+            if (wifiState != WIFI_CONNECTED) break;
+            if (strlen(config.MQTT_HOST) == 0 && !updateBroker()) {
+                mqttLast = millis();
+                mqttState = MQTT_FAILED;
+                connectFailed();
+                break;
+            }
+            LOG_INFO(LOG_MQTT_CONNECTING);
+            mqttClient.setServer(config.MQTT_HOST, config.MQTT_PORT);
+            mqttAttempts = 0;
+            mqttLast = millis() - mqttDelay;
+            mqttState = MQTT_CONNECTING;
+            break;
+        case MQTT_CONNECTING:
+            if (!timerElapsed(mqttLast, mqttDelay)) break;
+            mqttLast = millis();
+            // Подключение блокирует тик сетевой задачи до MQTT_TIMEOUT; радиомост на другом ядре продолжает работу.
+            if (mqttClient.connect(WiFi.macAddress().c_str(), config.MQTT_USERNAME, config.MQTT_PASSWORD)) {
+                LOG_INFO(LOG_MQTT_CONNECTED);
+                if (bootMqtt == 0) {
+                    bootMqtt = millis();
+                    bootReport();
+                }
+                mqttSubscribe();
+                clientReady = true;
+                mqttBackoff = MQTT_RETRY_INTERVAL;
+                mqttDelay = MQTT_RETRY_INTERVAL;
+                mqttState = MQTT_CONNECTED;
+            } else if (clientReady) {
+                // После обрыва переподключение не прекращается, но пауза растёт со случайным разбросом,
+                // чтобы хабы не ломились к брокеру одновременно.
+                mqttBackoff = min(mqttBackoff * 2, static_cast<unsigned long>(MQTT_BACKOFF_MAX));
+                mqttDelay = mqttBackoff / 2 + random(mqttBackoff / 2 + 1);
+            } else if (++mqttAttempts >= MQTT_ATTEMPTS) {
+                LOG_WARN(LOG_MQTT_NOT_CONNECTED);
+                mqttState = MQTT_FAILED;
+                connectFailed();
+            }
+            break;
+        case MQTT_CONNECTED:
+            if (!mqttClient.loop()) {
+                LOG_WARN(LOG_MQTT_LOST);
+                mqttReconnects++;
+                mqttState = MQTT_IDLE;
+            }
+            break;
+        case MQTT_FAILED:
+            if (timerElapsed(mqttLast, RECONNECT_INTERVAL)) mqttState = MQTT_IDLE;
+            break;
     }
-    Serial.println("not connected");
-    return false;
 }
 
 void mqttReceive(const char *topic, const byte *payload, const unsigned int length) {
-    char value[length + 1];
+    if (length > MQTT_PAYLOAD_MAX) return;
+    char value[MQTT_PAYLOAD_MAX + 1];
     memcpy(value, payload, length);
     value[length] = '\0';
 
-    Serial.print("MQTT payload received: ");
-    Serial.print(topic);
-    Serial.print(" - ");
-    Serial.println(value);
+    char id[16];
+    const char *separator = strchr(topic, '/');
+    if (!separator || separator - topic >= static_cast<long>(sizeof(id))) return;
+    memcpy(id, topic, separator - topic);
+    id[separator - topic] = '\0';
+
+    Node *node = nodeFind(id);
+    if (!node) return;
+
+    const char *command = separator + 1;
+    char *end;
+    const unsigned long zone = strtoul(command, &end, 10);
+    const bool zoned = end != command && *end == '/';
+    if (zoned) command = end + 1;
+
+    const Signal signal = signalByTopic(command);
+    if (signal == SIGNAL_NONE) return;
+    const SignalSpec &spec = SIGNALS[signal];
+    if (spec.direction != SIGNAL_COMMAND || spec.zoned != zoned) return;
+    if (zoned && (zone < 1 || zone > node->zones)) return;
+    const uint8_t index = zoned ? zone - 1 : 0;
+    LOG_DEBUG(LOG_MQTT_COMMAND, node->addressLow, signal, zone);
+
+    if (spec.value == VALUE_CALIBRATION) {
+        zbSendCalibration(*node, index, value);
+        return;
+    }
+
+    const long number = atol(value);
+    if (number < spec.min || number > spec.max) {
+        LOG_WARN(LOG_MQTT_RANGE, number, signal);
+        return;
+    }
+    zbSendCommand(*node, spec.type, index, static_cast<int16_t>(number));
+    if (signalIsState(signal)) downlinkDesired(*node, signal, index, static_cast<int16_t>(number));
+
+    if (signal == SIGNAL_SLEEP) downlinkNode(*node, DOWNLINK_SLEEPY, number != 0);
+}
+
+/* Задачи */
+
+void radioTask() {
+    for (unsigned int i = 0; i < RADIO_FRAMES_PER_TICK && radioSerial().available() > 0; i++) xbeeClient.loop();
+}
+
+void linkTask() {
+    for (const Node &node: nodes) {
+        if (!nodeEmpty(node)) linkTimeouts(node);
+    }
+}
+
+void weatherTask() {
+    if (!clientReady || !timerElapsed(weatherLast, weatherDelay)) return;
+    weatherLast = millis();
+    weatherDelay = WEATHER_INTERVAL;
 
-    if (strcmp(topic, MQTT_TOPIC_REFERENCE) == 0) {
-        zbSend(XBEE_COMMAND_REFERENCE, value);
-    } else if (strcmp(topic, MQTT_TOPIC_MODE) == 0) {
-        zbSend(XBEE_COMMAND_MODE, value);
+    if (!forecastFresh() && (wifiState != WIFI_CONNECTED || !forecastFetch())) {
+        LOG_WARN(LOG_FORECAST_CACHED);
+        weatherDelay = WEATHER_RETRY_INTERVAL;
     }
+    if (forecastValid()) zbSendForecastAll();
+}
+
+void registerTask() {
+    if (mqttState != MQTT_CONNECTED || !timerElapsed(registerLast, REGISTER_INTERVAL)) return;
+    registerNodes();
+    registerLast = millis();
+}
+
+void serverTask() { webServer.handleClient(); }
+
+void restartTask() {
+    if (!restartPending || !timerElapsed(restartLast, RESTART_DELAY)) return;
+    configStore.flush();
+    networkStore.flush();
+    shadowStore.flush();
+    platformRestart();
+}
+
+void logTask() { logDrain(Serial); }
+
+void configTask() {
+    if (nodesSnapshot.take(config.NODES)) saveConfig();
+    if (shadowsSnapshot.take(shadowsStored)) shadowStore.save();
+    configStore.task(CONFIG_COMMIT_DELAY);
+    networkStore.task(CONFIG_COMMIT_DELAY);
+    shadowStore.task(CONFIG_COMMIT_DELAY);
+}
+
+void linkStatsTask();
+void statsTask();
+void diagnosticsTask();
+
+Task radioTasks[] = {
+    {"radio", radioTask, 0},
+    {"downlink", downlinkTask, 0},
+    {"link", linkTask, 100},
+    {"link stats", linkStatsTask, STATS_INTERVAL},
+};
+
+Task clientTasks[] = {
+    {"wifi", wifiTask, 100},
+    {"mqtt", mqttTask, 0},
+    {"outbound", outboundTask, 0},
+    {"weather", weatherTask, 1000},
+    {"register", registerTask, 1000},
+    {"config", configTask, 1000},
+    {"stats", statsTask, STATS_INTERVAL},
+    {"diagnostics", diagnosticsTask, DIAGNOSTICS_INTERVAL},
+    {"server", serverTask, 0},
+    {"log", logTask, 0},
+};
+
+Task hostTasks[] = {
+    {"server", serverTask, 0},
+    {"log", logTask, 0},
+    {"config", configTask, 1000},
+    {"restart", restartTask, 100},
+};
+
+// Радиомост на своём ядре: рукопожатие TLS или запись во флеш в loop() не задерживают кадры ZigBee.
+// В режиме настройки радио не обслуживается, и задача завершается.
+void radioLoop(void *) {
+#ifdef HEAP_AUDIT
+    heapAuditWatch();
+    bool warm = false;
+#endif
+    while (!serverMode) {
+#ifdef HEAP_AUDIT
+        const unsigned long before = heapAllocations();
+#endif
+        const unsigned long started = micros();
+        schedulerLoop(radioTasks);
+        metrics.radioLoop.record(micros() - started);
+#ifdef HEAP_AUDIT
+        if (warm) heapAuditCheck("radio loop", before);
+        warm = true;
+#endif
+        platformYield();
+    }
+    radioHandle = nullptr;
+    platformTaskExit();
+}
+
+void publishLink(const Node &node) {
+    const LinkStats &link = nodeState(node).link;
+    publishNode(node, MQTT_TOPIC_LINK_DELIVERED, link.delivered);
+    publishNode(node, MQTT_TOPIC_LINK_RETRIES, link.retries);
+    publishNode(node, MQTT_TOPIC_LINK_FAILED, link.failed);
+    publishNode(node, MQTT_TOPIC_LINK_TX_FAILED, link.txFailures);
+    publishNode(node, MQTT_TOPIC_LINK_LATENCY, link.delivered > 0 ? link.latencyTotal / link.delivered : 0);
+    publishNode(node, MQTT_TOPIC_LINK_LATENCY_MAX, link.latencyMax);
+}
+
+void linkStatsTask() {
+    for (const Node &node: nodes) {
+        if (!nodeEmpty(node)) publishLink(node);
+    }
+}
+
+void publishHub(const char *topic, const unsigned long value) {
+    char topicBuffer[64];
+    char valueBuffer[12];
+    snprintf(topicBuffer, sizeof(topicBuffer), MQTT_TOPIC_HUB, topic);
+    snprintf(valueBuffer, sizeof(valueBuffer), "%lu", value);
+    mqttPublish(topicBuffer, valueBuffer, QUEUE_LATEST);
+}
+
+// Этапы старта в мс от включения: сколько сеть узлов оставалась без хаба после сброса.
+void bootReport() {
+    LOG_INFO(LOG_BOOT, bootRadio, bootWifi, bootMqtt, bootFast);
+    publishHub(MQTT_TOPIC_BOOT_REASON, platformResetReason());
+    publishHub(MQTT_TOPIC_BOOT_FAST, bootFast);
+    publishHub(MQTT_TOPIC_BOOT_RADIO, bootRadio);
+    publishHub(MQTT_TOPIC_BOOT_WIFI, bootWifi);
+    publishHub(MQTT_TOPIC_BOOT_MQTT, bootMqtt);
+}
+
+// Доля времени в процентах, которую задачи планировщика были заняты с прошлого отчёта.
+unsigned long cpuLoad(const unsigned long busy, unsigned long &last, const unsigned long elapsed) {
+    const unsigned long load = elapsed > 0 ? (busy - last) / 10 / elapsed : 0;
+    last = busy;
+    return load;
+}
+
+void statsTask() {
+    const unsigned long elapsed = millis() - cpuLast;
+    cpuLast = millis();
+    schedulerReport(0, radioTasks);
+    schedulerReport(1, clientTasks);
+    publishHub(MQTT_TOPIC_CPU_RADIO, cpuLoad(schedulerBusy(radioTasks), cpuRadioBusy, elapsed));
+    publishHub(MQTT_TOPIC_CPU_NETWORK, cpuLoad(schedulerBusy(clientTasks), cpuNetworkBusy, elapsed));
+    if (radioHandle) publishHub(MQTT_TOPIC_RADIO_STACK, platformTaskStack(radioHandle));
+    publishHub(MQTT_TOPIC_UPLINK_HIGH, uplink.highWater());
+    publishHub(MQTT_TOPIC_UPLINK_DROPPED, uplinkDropped);
+    publishHub(MQTT_TOPIC_DOWNLINK_HIGH, downlink.highWater());
+    publishHub(MQTT_TOPIC_DOWNLINK_DROPPED, downlinkDropped);
+    publishHub(MQTT_TOPIC_QUEUE_DEPTH, outbound.size());
+    publishHub(MQTT_TOPIC_QUEUE_DROPPED, outboundDropped);
+    publishHub(MQTT_TOPIC_RECONNECTS, mqttReconnects);
+    publishHub(MQTT_TOPIC_HTTPS_REQUESTS, httpsRequests);
+    publishHub(MQTT_TOPIC_HTTPS_HANDSHAKES, httpsHandshakes);
+    publishHub(MQTT_TOPIC_LOG_WRITTEN, logWritten());
+    publishHub(MQTT_TOPIC_LOG_DROPPED, logDropped());
+    publishHub(MQTT_TOPIC_LOG_BYTES, logBytes);
+    LOG_INFO(LOG_CONFIG_WRITES, configStore.writes());
+}
+
+/* Диагностика */
+
+// Дописывает в metricsBuffer с позиции length; при переполнении строка просто обрезается.
+size_t metricsAppend(const size_t length, const char *format, ...) {
+    if (length >= sizeof(metricsBuffer)) return length;
+    va_list args;
+    va_start(args, format);
+    const int written = vsnprintf(metricsBuffer + length, sizeof(metricsBuffer) - length, format, args);
+    va_end(args);
+    return written > 0 ? length + written : length;
+}
+
+template<size_t N>
+size_t metricsHistogram(size_t length, const char *name, const Histogram<N> &histogram) {
+    length = metricsAppend(length, ",\"%s\":{\"count\":%lu,\"max\":%lu,\"buckets\":[", name,
+                           static_cast<unsigned long>(histogram.total()),
+                           static_cast<unsigned long>(histogram.maximum()));
+    for (size_t i = 0; i < histogram.buckets(); i++) {
+        length = metricsAppend(length, i > 0 ? ",%lu" : "%lu", static_cast<unsigned long>(histogram.count(i)));
+    }
+    return metricsAppend(length, "]}");
+}
+
+// Снимок счётчиков одной строкой JSON; границы корзин — LOOP_BUCKETS (мкс) и RELAY_BUCKETS (мс) из Structs.h.
+// Счётчики пишут обе задачи, а читаются они без блокировки: значение может отстать на одну итерацию.
+const char *metricsSnapshot() {
+    size_t length = metricsAppend(0,
+        "{\"uptime\":%lu,\"heap\":{\"free\":%lu,\"largest\":%lu},"
+        "\"xbee\":{\"in\":%lu,\"out\":%lu,\"invalid\":%lu},"
+        "\"mqtt\":{\"published\":%lu,\"failed\":%lu,\"queued\":%u},"
+        "\"https\":{\"requests\":%lu,\"handshakes\":%lu,\"failed\":%lu}",
+        millis() / 1000, static_cast<unsigned long>(platformHeapFree()),
+        static_cast<unsigned long>(platformHeapLargest()), static_cast<unsigned long>(metrics.framesIn),
+        static_cast<unsigned long>(metrics.framesOut), static_cast<unsigned long>(metrics.framesInvalid),
+        static_cast<unsigned long>(metrics.mqttPublished), static_cast<unsigned long>(metrics.mqttFailed),
+        static_cast<unsigned>(outbound.size()), httpsRequests, httpsHandshakes,
+        static_cast<unsigned long>(metrics.httpsFailed));
+    length = metricsHistogram(length, "radio_loop", metrics.radioLoop);
+    length = metricsHistogram(length, "network_loop", metrics.networkLoop);
+    length = metricsHistogram(length, "relay", metrics.relay);
+    metricsAppend(length, "}");
+    return metricsBuffer;
+}
+
+// Снимок уходит мимо очереди: в Outbound он не помещается, а при обрыве связи важен только следующий.
+void diagnosticsTask() {
+    if (!mqttClient.connected()) return;
+    char topic[64];
+    snprintf(topic, sizeof(topic), MQTT_TOPIC_HUB, MQTT_TOPIC_DIAGNOSTICS);
+    mqttClient.publish(topic, metricsSnapshot()) ? metrics.mqttPublished++ : metrics.mqttFailed++;
 }
 
 /* База */
@@ -344,48 +1706,77 @@ void setupHost() {
     wifiShare();
     setupServer();
 
-    Serial.println("Host is set up.");
+    LOG_INFO(LOG_HOST_READY);
 }
 
 void setupClient() {
-    Serial2.begin(9600);
+    radioSerial().begin(9600);
 
     mqttClient.setServer(config.MQTT_HOST, config.MQTT_PORT);
     mqttClient.setCallback(mqttReceive);
+    mqttClient.setBufferSize(MQTT_BUFFER_SIZE);
+    mqttClient.setSocketTimeout(MQTT_TIMEOUT / 1000);
+
+    // В рабочем режиме сервер отдаёт только /metrics; портал настройки поднимает setupServer.
+    webServer.on("/metrics", HTTP_GET, handleMetrics);
+    webServer.begin();
 
-    xbeeClient.setSerial(Serial2);
+    xbeeClient.setSerial(radioSerial());
     xbeeClient.onZBRxResponse(zbReceive);
+    xbeeClient.onZBTxStatusResponse(zbTxStatus);
+    // Случайное начало нумерации, чтобы после перезагрузки хаба узел не принял новые команды за повторы.
+    for (NodeState &state: nodeStates) {
+        state.seqNext = random(1, 256);
+        memset(&state.reported, 0xFF, sizeof(state.reported));
+    }
 
-    Serial.println("Client is set up.");
+    httpsSetup(wqttOrigin);
+    httpsSetup(weatherOrigin);
+
+    // Параметры сети хранит networkStore, а запись их во флеш при каждом WiFi.begin только тормозит старт.
+    WiFi.persistent(false);
+    WiFi.mode(WIFI_STA);
+
+    platformTaskStart(radioLoop, "radio", RADIO_STACK, RADIO_PRIORITY, RADIO_CORE, radioHandle);
+    bootRadio = millis();
+    LOG_INFO(LOG_CLIENT_READY);
+}
+
+void connectFailed() {
+    // Сохранённые параметры сети могли устареть: прежде чем сдаться, подключаемся заново обычным путём.
+    if (wifiFast) {
+        LOG_WARN(LOG_WIFI_CACHE_DROPPED);
+        networkForget();
+        wifiFast = false;
+        wifiStatic = false;
+        WiFi.disconnect();
+        wifiState = WIFI_IDLE;
+        mqttState = MQTT_IDLE;
+        return;
+    }
+    if (clientReady || serverMode) return;
+    serverMode = true;
+    setupHost();
 }
 
 void setup() {
-    Serial.begin(9600);
-    Serial.println();
+    Serial.begin(LOG_BAUD);
 
-    clientSecure.setInsecure();
     loadConfig();
 
     pinMode(PIN_LED, OUTPUT);
     pinMode(PIN_MODE, INPUT_PULLUP);
 
-    serverMode = digitalRead(PIN_MODE) == LOW || !wifiConnect() || !mqttConnect();
+    serverMode = digitalRead(PIN_MODE) == LOW;
     serverMode ? setupHost() : setupClient();
 }
 
-void loopHost() {
-    webServer.handleClient();
-}
-
-void loopClient() {
-    mqttClient.loop();
-    xbeeClient.loop();
-
-    const unsigned long now = millis();
-    if (now < weatherLast || millis() - weatherLast > WEATHER_INTERVAL) {
-        zbSend(XBEE_COMMAND_RAIN, willRainToday() ? "1" : "0");
-        weatherLast = millis();
+void loop() {
+    if (serverMode) {
+        schedulerLoop(hostTasks);
+        return;
     }
+    const unsigned long started = micros();
+    schedulerLoop(clientTasks);
+    metrics.networkLoop.record(micros() - started);
 }
-
-void loop() { serverMode ? loopHost() : loopClient(); }
@@ -0,0 +1,45 @@
+function showPosition(position) {
+  document.getElementById('latitude').value = position.coords.latitude.toFixed(6);
+  document.getElementById('longitude').value = position.coords.longitude.toFixed(6);
+  document.getElementById("location_status").innerHTML = "Координаты получены!";
+}
+
+function showError(error) {
+  var statusP = document.getElementById("location_status");
+  switch(error.code) {
+    case error.PERMISSION_DENIED:
+      statusP.innerHTML = "Запрос геолокации отклонен."
+      break;
+    case error.POSITION_UNAVAILABLE:
+      statusP.innerHTML = "Информация о местоположении недоступна."
+      break;
+    case error.TIMEOUT:
+      statusP.innerHTML = "Тайм-аут запроса геолокации."
+      break;
+    case error.UNKNOWN_ERROR:
+      statusP.innerHTML = "Неизвестная ошибка геолокации."
+      break;
+  }
+}
+
+function confirmReset() {
+  var messageDiv = document.getElementById('message-container');
+  messageDiv.innerHTML = '';
+  if (confirm("Вы уверены, что хотите сбросить все настройки до заводских? Это действие необратимо и приведет к перезагрузке устройства.")) {
+    messageDiv.innerHTML = '<p>Выполняется сброс...</p>';
+    fetch('/reset', { method: 'POST' })
+      .then(response => {
+        if (!response.ok) {
+          throw new Error('Network response was not ok: ' + response.statusText);
+        }
+        return response.text();
+      })
+      .then(data => {
+        messageDiv.innerHTML = '<p class="success">' + data + '</p>';
+      })
+      .catch(error => {
+        console.error('Error during reset:', error);
+        messageDiv.innerHTML = '<p class="error">Ошибка при сбросе настроек: ' + error.message + '</p>';
+      });
+  }
+}
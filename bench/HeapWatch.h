@@ -0,0 +1,42 @@
+#ifndef HEAP_WATCH_H
+#define HEAP_WATCH_H
+
+#include <Arduino.h>
+
+/*
+ * Пик кучи за время замера на ESP32 для бенчмарков в bench/.
+ * Задача на ядре 0 раз в тик опрашивает свободную кучу и запоминает наименьшее значение,
+ * поэтому видны и выделения внутри библиотек: рукопожатие mbedTLS, replace() у String.
+ * Выделение короче тика может проскочить, так что пик — оценка снизу.
+ */
+
+inline volatile uint32_t heapWatchLow;
+
+inline void heapWatchTask(void *) {
+    for (;;) {
+        const uint32_t free = ESP.getFreeHeap();
+        if (free < heapWatchLow) heapWatchLow = free;
+        vTaskDelay(1);
+    }
+}
+
+// Приоритет выше, чем у задач замера, чтобы опрос не ждал их на том же ядре.
+inline void heapWatchBegin() {
+    heapWatchLow = ESP.getFreeHeap();
+    xTaskCreatePinnedToCore(heapWatchTask, "heapWatch", 2048, nullptr, 5, nullptr, 0);
+}
+
+// Начинает замер и возвращает свободную кучу в его начале.
+inline uint32_t heapWatchStart() {
+    const uint32_t free = ESP.getFreeHeap();
+    heapWatchLow = free;
+    return free;
+}
+
+// Сколько кучи было занято сверх начала замера в худший момент.
+inline uint32_t heapWatchPeak(const uint32_t start) {
+    const uint32_t low = min(static_cast<uint32_t>(heapWatchLow), ESP.getFreeHeap());
+    return start > low ? start - low : 0;
+}
+
+#endif
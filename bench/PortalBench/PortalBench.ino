@@ -0,0 +1,176 @@
+/*
+ * Портал настройки хаба на плате: пик кучи и время до первого байта страницы двумя обработчиками.
+ *   /before — как до сборки страниц: страница из флеша в String, пять replace(), ответ одним куском;
+ *   /after  — как сейчас в Hub/main.cpp: chunked-ответ из сегментов Pages.h и значений полей между ними.
+ * Плата поднимает точку доступа и сервер, а задача-клиент на ядре 0 запрашивает обе страницы через
+ * петлевой интерфейс и печатает итоги в Serial. Пик кучи считается сервером на каждый запрос, так что
+ * страницы можно открывать и с телефона в сети PortalBench: строки запросов печатаются так же.
+ * В пик входят и буферы петлевого соединения клиента, одинаковые для обеих страниц.
+ */
+
+#include <WebServer.h>
+#include <WiFi.h>
+
+#include "../../Hub/Pages.h"
+#include "../HeapWatch.h"
+#include "PagesBefore.h"
+
+constexpr char AP_SSID[] = "PortalBench";
+constexpr uint16_t HTTP_PORT = 80;
+constexpr int RUNS = 20;
+constexpr unsigned long FETCH_TIMEOUT = 5000;
+
+// Настройки, которые подставляются в поля страницы: длиной как у настоящих.
+constexpr char SETTING_SSID[] = "garden-2.4GHz";
+constexpr char SETTING_PASSWORD[] = "correct horse battery";
+constexpr char SETTING_TOKEN[] = "0123456789abcdef0123456789abcdef";
+constexpr float SETTING_LATITUDE = 55.751244f;
+constexpr float SETTING_LONGITUDE = 37.618423f;
+
+WebServer webServer(HTTP_PORT);
+
+/* Сервер */
+
+void requestReport(const char *path, const uint32_t peak, const unsigned long started) {
+    Serial.printf("%-7s heap peak %6lu B, handler %5lu us\n", path, static_cast<unsigned long>(peak), micros() - started);
+}
+
+void handleBefore() {
+    const unsigned long started = micros();
+    const uint32_t heap = heapWatchStart();
+
+    String content = FPSTR(HTML_PAGE_INDEX);
+    content.replace("%SSID_VAL%", SETTING_SSID);
+    content.replace("%PASS_VAL%", SETTING_PASSWORD);
+    content.replace("%WQTT_TOKEN_VAL%", SETTING_TOKEN);
+    content.replace("%LATITUDE_VAL%", String(SETTING_LATITUDE));
+    content.replace("%LONGITUDE_VAL%", String(SETTING_LONGITUDE));
+    webServer.send(200, "text/html", content);
+
+    requestReport("/before", heapWatchPeak(heap), started);
+}
+
+void sendText(const char *text) { webServer.sendContent(text, strlen(text)); }
+
+void sendField(const PageField field) {
+    char buffer[16];
+    switch (field) {
+        case PAGE_FIELD_SSID_VAL: sendText(SETTING_SSID); break;
+        case PAGE_FIELD_PASS_VAL: sendText(SETTING_PASSWORD); break;
+        case PAGE_FIELD_WQTT_TOKEN_VAL: sendText(SETTING_TOKEN); break;
+        case PAGE_FIELD_LATITUDE_VAL:
+            snprintf(buffer, sizeof(buffer), "%.6f", SETTING_LATITUDE);
+            sendText(buffer);
+            break;
+        case PAGE_FIELD_LONGITUDE_VAL:
+            snprintf(buffer, sizeof(buffer), "%.6f", SETTING_LONGITUDE);
+            sendText(buffer);
+            break;
+        default:
+            break;
+    }
+}
+
+void handleAfter() {
+    const unsigned long started = micros();
+    const uint32_t heap = heapWatchStart();
+
+    webServer.setContentLength(CONTENT_LENGTH_UNKNOWN);
+    webServer.send(200, "text/html", "");
+    for (const PageSegment &segment: PAGE_INDEX) {
+        webServer.sendContent_P(segment.text);
+        sendField(segment.field);
+    }
+    webServer.sendContent("", 0);
+
+    requestReport("/after", heapWatchPeak(heap), started);
+}
+
+/* Клиент */
+
+struct Fetch {
+    unsigned long firstByte;
+    unsigned long total;
+    size_t bytes;
+};
+
+// Время до первого байта отсчитывается от отправки запроса, соединение уже открыто.
+bool fetch(const char *path, Fetch &result) {
+    WiFiClient client;
+    if (!client.connect(IPAddress(127, 0, 0, 1), HTTP_PORT)) return false;
+
+    const unsigned long started = micros();
+    client.printf("GET %s HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: close\r\n\r\n", path);
+    while (!client.available()) {
+        if (!client.connected() || micros() - started > FETCH_TIMEOUT * 1000) return false;
+        delay(1);
+    }
+    result.firstByte = micros() - started;
+
+    uint8_t buffer[512];
+    result.bytes = 0;
+    while (client.connected() || client.available()) {
+        const int length = client.read(buffer, sizeof(buffer));
+        if (length > 0) {
+            result.bytes += length;
+        } else {
+            delay(1);
+        }
+    }
+    result.total = micros() - started;
+    client.stop();
+    return true;
+}
+
+void benchPath(const char *path) {
+    unsigned long firstByteMin = ULONG_MAX;
+    unsigned long firstByteMax = 0;
+    unsigned long firstByteSum = 0;
+    unsigned long totalSum = 0;
+    size_t bytes = 0;
+    int done = 0;
+    for (int run = 0; run < RUNS; run++) {
+        Fetch result;
+        if (!fetch(path, result)) continue;
+        firstByteMin = min(firstByteMin, result.firstByte);
+        firstByteMax = max(firstByteMax, result.firstByte);
+        firstByteSum += result.firstByte;
+        totalSum += result.total;
+        bytes = result.bytes;
+        done++;
+        delay(100);
+    }
+    if (done == 0) {
+        Serial.printf("%-7s no response\n", path);
+        return;
+    }
+    Serial.printf("%-7s %d runs, %u B: first byte min %lu avg %lu max %lu us, total avg %lu us, boot heap low %lu B\n",
+                  path, done, static_cast<unsigned>(bytes), firstByteMin, firstByteSum / done, firstByteMax, totalSum / done,
+                  static_cast<unsigned long>(ESP.getMinFreeHeap()));
+}
+
+// Сначала новый обработчик: наименьшая куча с загрузки только падает, и старый не скроет его минимум.
+void benchTask(void *) {
+    delay(1000);
+    benchPath("/after");
+    benchPath("/before");
+    Serial.println("done");
+    vTaskDelete(nullptr);
+}
+
+void setup() {
+    Serial.begin(115200);
+    WiFi.mode(WIFI_AP);
+    WiFi.softAP(AP_SSID);
+
+    webServer.on("/before", HTTP_GET, handleBefore);
+    webServer.on("/after", HTTP_GET, handleAfter);
+    webServer.begin();
+
+    heapWatchBegin();
+    Serial.printf("PortalBench on %s, page %u B before, heap free %lu B\n", WiFi.softAPIP().toString().c_str(),
+                  static_cast<unsigned>(strlen_P(HTML_PAGE_INDEX)), static_cast<unsigned long>(ESP.getFreeHeap()));
+    xTaskCreatePinnedToCore(benchTask, "bench", 4096, nullptr, 1, nullptr, 0);
+}
+
+void loop() { webServer.handleClient(); }
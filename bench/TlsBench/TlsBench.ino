@@ -0,0 +1,142 @@
+/*
+ * HTTPS-запросы хаба на плате: рукопожатия, задержка и пик кучи на запрос тремя способами.
+ *   insecure — как раньше: новое соединение на каждый запрос и setInsecure();
+ *   pinned   — новое соединение, но сертификат сервера проверяется по своему корню;
+ *   reuse    — как сейчас в Hub/main.cpp: проверка по корню и одно соединение keep-alive на сервер.
+ * Сервер — tools/tlsserver.py на компьютере в той же сети; он же пишет BenchCa.h с корнем и адресом,
+ * а имя и пароль сети задаются ниже. Итоги печатаются в Serial, а сервер печатает свои рукопожатия.
+ */
+
+#include <HTTPClient.h>
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+
+#include "../HeapWatch.h"
+
+#if __has_include("BenchCa.h")
+#include "BenchCa.h"
+#else
+#error "Run python3 tools/tlsserver.py <address of this computer> first: it writes BenchCa.h"
+#endif
+
+constexpr char WIFI_SSID[] = "";
+constexpr char WIFI_PASSWORD[] = "";
+
+constexpr int RUNS = 10;
+constexpr unsigned long REQUEST_PAUSE = 500;
+constexpr unsigned long HTTP_TIMEOUT = 1000l * 10l;
+
+// Запросы чередуются, как вызовы updateBroker() и forecastFetch(), но идут к одному серверу.
+const char *const PATHS[] = {"/api/broker", "/v1/forecast"};
+
+// Тело ответа только вычитывается: разбор JSON здесь не меряется.
+class Discard : public Print {
+public:
+    size_t write(uint8_t) override { return 1; }
+    size_t write(const uint8_t *, const size_t size) override { return size; }
+};
+
+struct Mode {
+    const char *name;
+    bool verify;
+    bool reuse;
+};
+
+const Mode MODES[] = {
+    {"insecure", false, false},
+    {"pinned", true, false},
+    {"reuse", true, true},
+};
+
+struct Request {
+    bool ok;
+    bool handshake;
+    unsigned long latency;
+    uint32_t heap;
+};
+
+Request request(WiFiClientSecure &client, HTTPClient &http, const char *path) {
+    char url[96];
+    snprintf(url, sizeof(url), "https://%s:%u%s", BENCH_HOST, BENCH_PORT, path);
+
+    Request result = {false, !client.connected(), 0, 0};
+    const uint32_t heap = heapWatchStart();
+    const unsigned long started = millis();
+    if (http.begin(client, url)) {
+        Discard body;
+        result.ok = http.GET() == 200 && http.writeToStream(&body) >= 0;
+        http.end();
+    }
+    result.latency = millis() - started;
+    result.heap = heapWatchPeak(heap);
+    return result;
+}
+
+void setupHttp(WiFiClientSecure &client, HTTPClient &http, const Mode &mode) {
+    if (mode.verify) {
+        client.setCACert(BENCH_CA);
+    } else {
+        client.setInsecure();
+    }
+    client.setHandshakeTimeout(HTTP_TIMEOUT / 1000);
+    http.setConnectTimeout(HTTP_TIMEOUT);
+    http.setTimeout(HTTP_TIMEOUT);
+    http.useHTTP10(true);
+    http.setReuse(mode.reuse);
+}
+
+void benchMode(const Mode &mode) {
+    // Для reuse клиент живёт весь прогон, для остальных создаётся заново на каждый запрос, как было раньше.
+    WiFiClientSecure sharedClient;
+    HTTPClient sharedHttp;
+    if (mode.reuse) setupHttp(sharedClient, sharedHttp, mode);
+
+    int done = 0;
+    int handshakes = 0;
+    unsigned long latencySum = 0;
+    unsigned long latencyMax = 0;
+    uint32_t heapMax = 0;
+    for (int run = 0; run < RUNS; run++) {
+        const char *path = PATHS[run % (sizeof(PATHS) / sizeof(PATHS[0]))];
+        Request result;
+        if (mode.reuse) {
+            result = request(sharedClient, sharedHttp, path);
+        } else {
+            WiFiClientSecure client;
+            HTTPClient http;
+            setupHttp(client, http, mode);
+            result = request(client, http, path);
+        }
+        Serial.printf("%-8s %2d %-13s %s handshake=%d %5lu ms heap peak %6lu B\n", mode.name, run, path,
+                      result.ok ? "ok    " : "failed", result.handshake, result.latency,
+                      static_cast<unsigned long>(result.heap));
+        if (result.ok) {
+            done++;
+            handshakes += result.handshake;
+            latencySum += result.latency;
+            latencyMax = max(latencyMax, result.latency);
+            heapMax = max(heapMax, result.heap);
+        }
+        delay(REQUEST_PAUSE);
+    }
+
+    sharedClient.stop();
+    Serial.printf("%-8s %d/%d ok, %d handshakes, latency avg %lu max %lu ms, heap peak max %lu B, free %lu B\n\n",
+                  mode.name, done, RUNS, handshakes, done > 0 ? latencySum / done : 0, latencyMax,
+                  static_cast<unsigned long>(heapMax), static_cast<unsigned long>(ESP.getFreeHeap()));
+}
+
+void setup() {
+    Serial.begin(115200);
+    WiFi.mode(WIFI_STA);
+    WiFi.begin(WIFI_SSID, WIFI_PASSWORD);
+    while (WiFi.status() != WL_CONNECTED) delay(100);
+
+    heapWatchBegin();
+    Serial.printf("TlsBench to %s:%u, heap free %lu B\n", BENCH_HOST, BENCH_PORT,
+                  static_cast<unsigned long>(ESP.getFreeHeap()));
+    for (const Mode &mode: MODES) benchMode(mode);
+    Serial.println("done");
+}
+
+void loop() { delay(1000); }
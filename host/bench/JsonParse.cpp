@@ -0,0 +1,230 @@
+/*
+ * Разбор ответов HTTPS хаба двумя способами на ответах настоящего размера.
+ *   string — как до потокового разбора: тело целиком в строку, затем весь документ в кучу;
+ *   stream — как сейчас: документ из потока через фильтр, память из Arena.
+ * Пик кучи — байты, которые в один момент держали строка и JsonDocument, без накладных расходов
+ * распределителя ESP32. Потоковый разбор кучу не трогает, его пик — заполнение статической арены.
+ * Время — среднее на разбор на этом хосте и годится только для сравнения способов между собой.
+ *
+ *   bench_json [--iterations N]
+ */
+
+#include <getopt.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <XBee.h>
+
+#include <ArduinoJson.h>
+
+#include "../../Hub/Arena.h"
+#include "../../Hub/Constants.h"
+
+/* Ответы */
+
+constexpr uint32_t FORECAST_START = 1780272000;
+
+// Ответ Open-Meteo с метаданными, как его отдаёт сервер; hours — длина ряда, unixtime — формат времени.
+std::string forecastJson(const int hours, const bool unixtime, const bool current) {
+    std::string times;
+    std::string rain;
+    for (int hour = 0; hour < hours; hour++) {
+        char value[32];
+        const uint32_t time = FORECAST_START + hour * 3600;
+        if (unixtime) {
+            snprintf(value, sizeof(value), "%s%u", hour > 0 ? "," : "", time);
+        } else {
+            snprintf(value, sizeof(value), "%s\"2026-06-%02uT%02u:00\"", hour > 0 ? "," : "", 1 + hour / 24, hour % 24);
+        }
+        times += value;
+        snprintf(value, sizeof(value), "%s%.2f", hour > 0 ? "," : "", hour % 7 == 3 ? 0.4 : 0.0);
+        rain += value;
+    }
+    const std::string timeUnit = unixtime ? "unixtime" : "iso8601";
+    std::string json = "{\"latitude\":55.75,\"longitude\":37.625,\"generationtime_ms\":0.02205371856689453,"
+                       "\"utc_offset_seconds\":0,\"timezone\":\"GMT\",\"timezone_abbreviation\":\"GMT\",\"elevation\":144.0,";
+    if (current) {
+        json += "\"current_units\":{\"time\":\"" + timeUnit + "\",\"interval\":\"seconds\",\"rain\":\"mm\"},"
+                "\"current\":{\"time\":" + std::to_string(FORECAST_START) + ",\"interval\":900,\"rain\":0.00},";
+    }
+    json += "\"hourly_units\":{\"time\":\"" + timeUnit + "\",\"rain\":\"mm\"},\"hourly\":{\"time\":[" + times +
+            "],\"rain\":[" + rain + "]}}";
+    return json;
+}
+
+std::string brokerJson() {
+    return "{\"server\":\"m5.wqtt.ru\",\"port\":5361,\"ssl_port\":5362,\"ws_port\":5363,\"user\":\"u_8KX2QF\","
+           "\"password\":\"Jq7vZ0tPb3sWn1Lc\",\"client_id\":\"hub-240ac4000001\",\"created\":\"2026-06-01T00:00:00Z\"}";
+}
+
+// WQTT возвращает созданное устройство целиком: все топики зон вокруг нужного device_id.
+std::string registerJson() {
+    std::string sensors;
+    for (int zone = 1; zone <= ZONES_MAX; zone++) {
+        const std::string prefix = "\"41000001/" + std::to_string(zone) + "/";
+        sensors += std::string(zone > 1 ? "," : "") + "{\"id\":" + std::to_string(9000 + zone) +
+                   ",\"type\":1,\"topic\":" + prefix + "moisture/value\",\"multiplier\":1,\"value\":null}," +
+                   "{\"id\":" + std::to_string(9100 + zone) + ",\"type\":5,\"topic\":" + prefix +
+                   "status\",\"value\":null},{\"id\":" + std::to_string(9200 + zone) + ",\"type\":2,\"topic_cmd\":" +
+                   prefix + "moisture/reference\",\"topic_state\":" + prefix +
+                   "moisture/reference/state\",\"min\":0,\"max\":100,\"precision\":1,\"multiplier\":1}";
+    }
+    return "{\"detail\":{\"device_id\":1207,\"name\":\"Полив\",\"type\":19,\"room\":\"Сад\",\"online\":false,"
+           "\"sensors\":[" + sensors + "]}}";
+}
+
+/* Распределители */
+
+// Куча с подсчётом: сколько байтов занято сейчас и сколько было занято самое большее.
+class CountingAllocator : public ArduinoJson::Allocator {
+public:
+    void *allocate(const size_t size) override {
+        auto *block = static_cast<size_t *>(malloc(sizeof(size_t) + size));
+        if (!block) return nullptr;
+        *block = size;
+        take(size);
+        return block + 1;
+    }
+
+    void deallocate(void *pointer) override {
+        if (!pointer) return;
+        auto *block = static_cast<size_t *>(pointer) - 1;
+        used -= *block;
+        free(block);
+    }
+
+    void *reallocate(void *pointer, const size_t size) override {
+        if (!pointer) return allocate(size);
+        auto *block = static_cast<size_t *>(pointer) - 1;
+        const size_t previous = *block;
+        block = static_cast<size_t *>(realloc(block, sizeof(size_t) + size));
+        if (!block) return nullptr;
+        *block = size;
+        used -= previous;
+        take(size);
+        return block + 1;
+    }
+
+    // Память вне документа, как строка с телом ответа.
+    void take(const size_t size) {
+        used += size;
+        if (used > high) high = used;
+    }
+
+    void release(const size_t size) { used -= size; }
+
+    size_t highWater() const { return high; }
+
+private:
+    size_t used = 0;
+    size_t high = 0;
+};
+
+/* Разбор */
+
+struct Response {
+    const char *name;
+    std::string body;
+    // Поля, которые читает прошивка, в виде фильтра ArduinoJson.
+    void (*filter)(JsonDocument &filter);
+};
+
+struct Result {
+    size_t memory = 0;
+    double micros = 0;
+    bool ok = true;
+};
+
+// Строка растёт, пока читается поток, как в HTTPClient::getString() без Content-Length.
+Result parseString(const Response &response, const int iterations) {
+    Result result;
+    CountingAllocator heap;
+    WiFiClient client;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        client.simRespond(response.body, 0);
+        std::string payload;
+        size_t reserved = 0;
+        for (int c; (c = client.read()) >= 0;) {
+            payload += static_cast<char>(c);
+            if (payload.capacity() != reserved) {
+                heap.release(reserved);
+                reserved = payload.capacity();
+                heap.take(reserved);
+            }
+        }
+
+        JsonDocument doc(&heap);
+        result.ok &= !deserializeJson(doc, payload.c_str(), payload.size());
+        heap.release(reserved);
+    }
+    result.micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+    result.memory = heap.highWater();
+    return result;
+}
+
+Result parseStream(const Response &response, const int iterations) {
+    Result result;
+    Arena<JSON_ARENA_SIZE> arena;
+    WiFiClient client;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++) {
+        client.simRespond(response.body, 0);
+        arena.reset();
+        JsonDocument filter(&arena);
+        response.filter(filter);
+        JsonDocument doc(&arena);
+        result.ok &= !deserializeJson(doc, client, DeserializationOption::Filter(filter));
+    }
+    result.micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / iterations;
+    result.memory = arena.highWater();
+    return result;
+}
+
+int main(int argc, char **argv) {
+    int iterations = 2000;
+    const option options[] = {{"iterations", required_argument, nullptr, 'i'}, {nullptr, 0, nullptr, 0}};
+    for (int option; (option = getopt_long(argc, argv, "", options, nullptr)) != -1;) {
+        if (option != 'i') {
+            fprintf(stderr, "usage: bench_json [--iterations N]\n");
+            return 2;
+        }
+        iterations = max(atoi(optarg), 1);
+    }
+
+    const auto forecastFilter = [](JsonDocument &filter) {
+        filter["current"]["time"] = true;
+        filter["hourly"]["time"] = true;
+        filter["hourly"]["rain"] = true;
+    };
+    const std::vector<Response> responses = {
+        {"forecast, 1 day iso8601", forecastJson(24, false, false), forecastFilter},
+        {"forecast, 24 h unixtime", forecastJson(24, true, true), forecastFilter},
+        {"forecast, 7 days", forecastJson(24 * 7, true, true), forecastFilter},
+        {"broker", brokerJson(),
+         [](JsonDocument &filter) {
+             filter["server"] = true;
+             filter["port"] = true;
+             filter["user"] = true;
+             filter["password"] = true;
+         }},
+        {"register", registerJson(), [](JsonDocument &filter) { filter["detail"]["device_id"] = true; }},
+    };
+
+    printf("%-24s %6s | %11s %8s | %12s %8s\n", "response", "bytes", "string heap", "us", "stream arena", "us");
+    bool ok = true;
+    for (const Response &response: responses) {
+        const Result string = parseString(response, iterations);
+        const Result stream = parseStream(response, iterations);
+        printf("%-24s %6zu | %11zu %8.1f | %12zu %8.1f\n", response.name, response.body.size(), string.memory,
+               string.micros, stream.memory, stream.micros);
+        ok &= string.ok && stream.ok;
+    }
+    if (!ok) fprintf(stderr, "some responses failed to parse\n");
+    return ok ? 0 : 1;
+}
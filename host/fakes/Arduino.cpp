@@ -0,0 +1,91 @@
+#include "Arduino.h"
+
+#if !defined(__GLIBC__) || __GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38)
+size_t strlcpy(char *destination, const char *source, const size_t size) {
+    const size_t length = strlen(source);
+    if (size > 0) {
+        const size_t copied = min(length, size - 1);
+        memcpy(destination, source, copied);
+        destination[copied] = '\0';
+    }
+    return length;
+}
+
+size_t strlcat(char *destination, const char *source, const size_t size) {
+    const size_t used = strnlen(destination, size);
+    if (used == size) return size + strlen(source);
+    return used + strlcpy(destination + used, source, size - used);
+}
+#endif
+
+/* Время */
+
+unsigned long millis() { return simMicros / 1000; }
+
+unsigned long micros() { return simMicros; }
+
+void delay(const unsigned long ms) { simAdvance(ms * 1000ull); }
+
+/* Выводы */
+
+void pinMode(const uint8_t pin, const uint8_t mode) { simBoard->pinModes[pin] = mode; }
+
+void digitalWrite(const uint8_t pin, const uint8_t value) { simBoard->pinOut[pin] = value ? HIGH : LOW; }
+
+// Выход читается так, как его выставила прошивка; вход без внешнего уровня — по подтяжке.
+int digitalRead(const uint8_t pin) {
+    const SimBoard &board = *simBoard;
+    if (board.pinModes[pin] == OUTPUT) return board.pinOut[pin];
+    if (board.pinIn[pin] >= 0) return board.pinIn[pin];
+    return board.pinModes[pin] == INPUT_PULLUP ? HIGH : LOW;
+}
+
+int analogRead(const uint8_t pin) { return simBoard->analog[pin]; }
+
+/* Случайность */
+
+long random(const long max) { return max > 0 ? random(0, max) : 0; }
+
+long random(const long min, const long max) {
+    if (max <= min) return min;
+    return std::uniform_int_distribution<long>(min, max - 1)(simRandom);
+}
+
+// Зерно прошивки не используется: последовательность задаёт симулятор, чтобы прогон повторялся.
+void randomSeed(unsigned long) {}
+
+/* Порты */
+
+// Консоль передаёт быстрее, чем прошивки пишут журнал, и буфер передатчика всегда свободен.
+constexpr int SERIAL_BUFFER = 256;
+
+int HardwareSerial::available() { return port == 2 ? simBoard->radioRx.size() : 0; }
+
+int HardwareSerial::read() {
+    if (port != 2 || simBoard->radioRx.empty()) return -1;
+    const uint8_t value = simBoard->radioRx.front();
+    simBoard->radioRx.pop_front();
+    return value;
+}
+
+int HardwareSerial::peek() { return port != 2 || simBoard->radioRx.empty() ? -1 : simBoard->radioRx.front(); }
+
+size_t HardwareSerial::write(const uint8_t value) { return write(&value, 1); }
+
+size_t HardwareSerial::write(const uint8_t *buffer, const size_t size) {
+    if (port == 2) {
+        simBoard->radioTx.insert(simBoard->radioTx.end(), buffer, buffer + size);
+    } else if (simBoard->log) {
+        fwrite(buffer, 1, size, simBoard->log);
+    }
+    return size;
+}
+
+int HardwareSerial::availableForWrite() { return SERIAL_BUFFER; }
+
+void HardwareSerial::flush() {
+    if (port != 2 && simBoard->log) fflush(simBoard->log);
+}
+
+HardwareSerial Serial(0);
+HardwareSerial Serial2(2);
@@ -0,0 +1,173 @@
+#ifndef ARDUINO_H
+#define ARDUINO_H
+
+#include <math.h>
+#include <stdarg.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+
+#include "Sim.h"
+
+/*
+ * Arduino API поверх симулятора: выводы, АЦП, порты и время текущей платы simBoard.
+ * Объявлено только то, чем пользуются прошивки, и ведёт себя так же, как ядра ESP32 и STM32.
+ */
+
+typedef uint8_t byte;
+
+#define LOW 0x0
+#define HIGH 0x1
+
+#define INPUT 0x0
+#define OUTPUT 0x1
+#define INPUT_PULLUP 0x2
+
+#define PROGMEM
+#define PGM_P const char *
+
+constexpr uint8_t A0 = 100;
+constexpr uint8_t A1 = 101;
+constexpr uint8_t A2 = 102;
+constexpr uint8_t A3 = 103;
+constexpr uint8_t A4 = 104;
+constexpr uint8_t A5 = 105;
+constexpr uint8_t A6 = 106;
+constexpr uint8_t A7 = 107;
+constexpr uint8_t A8 = 108;
+constexpr uint8_t A9 = 109;
+
+using std::max;
+using std::min;
+
+#define constrain(amount, low, high) ((amount) < (low) ? (low) : ((amount) > (high) ? (high) : (amount)))
+
+#if !defined(__GLIBC__) || __GLIBC__ < 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ < 38)
+size_t strlcpy(char *destination, const char *source, size_t size);
+size_t strlcat(char *destination, const char *source, size_t size);
+#endif
+
+/* Время */
+
+unsigned long millis();
+unsigned long micros();
+// Ожидание двигает общие часы: на плате за это время ничего другого не происходит.
+void delay(unsigned long ms);
+
+/* Выводы */
+
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+
+/* Случайность */
+
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+/* Строки */
+
+class String {
+public:
+    String(const char *text = "") : text(text ? text : "") {}
+    String(const std::string &text) : text(text) {}
+
+    const char *c_str() const { return text.c_str(); }
+    unsigned int length() const { return text.size(); }
+    long toInt() const { return atol(text.c_str()); }
+    float toFloat() const { return atof(text.c_str()); }
+
+    bool operator==(const String &other) const { return text == other.text; }
+    String operator+(const String &other) const { return text + other.text; }
+    friend String operator+(const char *left, const String &right) { return String(left) + right; }
+
+private:
+    std::string text;
+};
+
+/* Порты */
+
+class Print {
+public:
+    virtual ~Print() = default;
+
+    virtual size_t write(uint8_t value) = 0;
+
+    virtual size_t write(const uint8_t *buffer, size_t size) {
+        size_t written = 0;
+        while (size-- > 0) written += write(*buffer++);
+        return written;
+    }
+
+    size_t write(const char *buffer, const size_t size) { return write(reinterpret_cast<const uint8_t *>(buffer), size); }
+
+    virtual int availableForWrite() { return 0; }
+
+    virtual void flush() {}
+
+    size_t print(const char *text) { return write(text, strlen(text)); }
+    size_t print(const String &text) { return print(text.c_str()); }
+    size_t print(long value) { return print(std::to_string(value).c_str()); }
+    size_t print(unsigned long value) { return print(std::to_string(value).c_str()); }
+    size_t println() { return print("\r\n"); }
+
+    template<typename T>
+    size_t println(const T &value) {
+        const size_t written = print(value);
+        return written + println();
+    }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long) {}
+
+    size_t readBytes(char *buffer, const size_t length) {
+        size_t count = 0;
+        while (count < length) {
+            const int value = read();
+            if (value < 0) break;
+            buffer[count++] = static_cast<char>(value);
+        }
+        return count;
+    }
+
+    size_t readBytes(uint8_t *buffer, const size_t length) { return readBytes(reinterpret_cast<char *>(buffer), length); }
+};
+
+// Порт 0 — консоль платы, в неё идёт журнал; порт 2 — UART радиомодуля.
+class HardwareSerial : public Stream {
+public:
+    explicit HardwareSerial(int port) : port(port) {}
+
+    void begin(unsigned long) {}
+    void end() {}
+
+    int available() override;
+    int read() override;
+    int peek() override;
+    size_t write(uint8_t value) override;
+    size_t write(const uint8_t *buffer, size_t size) override;
+    int availableForWrite() override;
+    void flush() override;
+
+    using Print::write;
+
+private:
+    int port;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial2;
+
+#endif
@@ -0,0 +1,29 @@
+#ifndef EEPROM_H
+#define EEPROM_H
+
+#include <Arduino.h>
+
+/*
+ * EEPROM текущей платы. Поддержаны оба вида API: с begin(size)/commit() как у ESP32
+ * и с побайтной записью update() как у STM32 и AVR. Запись сразу попадает в память платы,
+ * поэтому commit() ничего не делает, а оборванная запись моделируется тестами напрямую.
+ */
+class EEPROMClass {
+public:
+    bool begin(size_t = 0) { return true; }
+    void end() {}
+    bool commit() { return true; }
+
+    uint8_t read(const int address) { return simBoard->eeprom[address]; }
+    void write(const int address, const uint8_t value) { simBoard->eeprom[address] = value; }
+    void update(const int address, const uint8_t value) { write(address, value); }
+
+    uint16_t length() { return SIM_EEPROM_SIZE; }
+};
+
+inline EEPROMClass EEPROM;
+
+// Последний адрес EEPROM, как в ядрах AVR и STM32.
+#define E2END (SIM_EEPROM_SIZE - 1)
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef HTTP_CLIENT_H
+#define HTTP_CLIENT_H
+
+#include <WiFi.h>
+
+/*
+ * Клиент HTTP поверх simHttp: запрос выполняется сразу, тело ответа читается из сокета как поток.
+ * С setReuse(true) соединение после ответа остаётся открытым, пока сервер не закроет его по простою.
+ */
+class HTTPClient {
+public:
+    bool begin(WiFiClient &client, const char *url);
+    void end();
+
+    void addHeader(const char *, const char *) {}
+    int GET() { return request("GET", std::string()); }
+    int POST(uint8_t *payload, const size_t size) { return request("POST", std::string(reinterpret_cast<char *>(payload), size)); }
+    WiFiClient &getStream() { return *client; }
+
+    void setConnectTimeout(int32_t) {}
+    void setTimeout(uint16_t) {}
+    void useHTTP10(bool = true) {}
+    void setReuse(const bool value) { reuse = value; }
+
+private:
+    WiFiClient *client = nullptr;
+    std::string url;
+    bool reuse = false;
+
+    int request(const char *method, const std::string &body);
+};
+
+#endif
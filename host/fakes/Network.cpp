@@ -0,0 +1,163 @@
+#include "HTTPClient.h"
+#include "PubSubClient.h"
+#include "WebServer.h"
+
+/* WiFi */
+
+static wl_status_t wifiStatus = WL_DISCONNECTED;
+static unsigned long wifiConnectAt;
+static IPAddress wifiStatic;
+static uint8_t wifiBssid[6] = {0x24, 0x0A, 0xC4, 0x10, 0x20, 0x30};
+
+constexpr int32_t WIFI_CHANNEL = 6;
+
+wl_status_t WiFiClass::status() {
+    if (!simWifi.available) wifiStatus = WL_DISCONNECTED;
+    if (wifiStatus == WL_IDLE_STATUS && millis() >= wifiConnectAt) wifiStatus = WL_CONNECTED;
+    return wifiStatus;
+}
+
+// Подключение без сканирования удаётся, только если точка на том же канале и с тем же BSSID.
+wl_status_t WiFiClass::begin(const char *, const char *, const int32_t channel, const uint8_t *bssid, bool) {
+    const bool known = channel != 0 && bssid;
+    if (!simWifi.available || (known && (channel != WIFI_CHANNEL || memcmp(bssid, wifiBssid, sizeof(wifiBssid)) != 0))) {
+        wifiStatus = WL_NO_SSID_AVAIL;
+        return wifiStatus;
+    }
+    wifiStatus = WL_IDLE_STATUS;
+    wifiConnectAt = millis() + (known ? 0 : simWifi.scanTime) + simWifi.associateTime + (wifiStatic != 0 ? 0 : simWifi.dhcpTime);
+    return wifiStatus;
+}
+
+bool WiFiClass::config(const IPAddress ip, IPAddress, IPAddress, IPAddress) {
+    wifiStatic = ip;
+    return true;
+}
+
+bool WiFiClass::disconnect(bool, bool) {
+    wifiStatus = WL_DISCONNECTED;
+    return true;
+}
+
+bool WiFiClass::softAP(const char *, const char *) { return true; }
+
+uint8_t *WiFiClass::BSSID() { return wifiBssid; }
+
+int32_t WiFiClass::channel() { return WIFI_CHANNEL; }
+
+IPAddress WiFiClass::localIP() { return wifiStatic != 0 ? wifiStatic : IPAddress(192, 168, 1, 50); }
+
+IPAddress WiFiClass::gatewayIP() { return IPAddress(192, 168, 1, 1); }
+
+IPAddress WiFiClass::subnetMask() { return IPAddress(255, 255, 255, 0); }
+
+IPAddress WiFiClass::dnsIP(uint8_t) { return IPAddress(192, 168, 1, 1); }
+
+bool WiFiClient::simConnect() {
+    if (WiFiClass::status() != WL_CONNECTED) return false;
+    open = true;
+    return true;
+}
+
+/* HTTP */
+
+bool HTTPClient::begin(WiFiClient &stream, const char *address) {
+    client = &stream;
+    url = address;
+    return true;
+}
+
+void HTTPClient::end() {
+    if (!reuse) client->stop();
+}
+
+// Коды меньше нуля — отказы до ответа сервера, как HTTPC_ERROR_CONNECTION_REFUSED в HTTPClient.
+int HTTPClient::request(const char *method, const std::string &body) {
+    if (!client->connected() && !client->simConnect()) return -1;
+    const SimResponse response = simHttp ? simHttp(method, url, body) : SimResponse{404, std::string(), 0};
+    client->simRespond(response.body, response.keepAlive);
+    return response.code;
+}
+
+/* MQTT */
+
+bool PubSubClient::connect(const char *, const char *, const char *) {
+    online = WiFiClass::status() == WL_CONNECTED && simBroker.online;
+    if (online) {
+        simBroker.connects++;
+        simBroker.subscriptions.clear();
+    }
+    return online;
+}
+
+bool PubSubClient::connected() {
+    if (WiFiClass::status() != WL_CONNECTED || !simBroker.online) online = false;
+    return online;
+}
+
+bool PubSubClient::loop() {
+    if (!connected()) return false;
+    for (auto message = simBroker.inbox.begin(); message != simBroker.inbox.end(); ++message) {
+        bool subscribed = false;
+        for (const std::string &filter: simBroker.subscriptions) subscribed |= simTopicMatch(filter.c_str(), message->topic.c_str());
+        if (!subscribed) continue;
+
+        SimMessage delivered = *message;
+        simBroker.inbox.erase(message);
+        if (callback) callback(&delivered.topic[0], reinterpret_cast<uint8_t *>(&delivered.payload[0]), delivered.payload.size());
+        break;
+    }
+    return true;
+}
+
+bool PubSubClient::publish(const char *topic, const char *payload, const bool retained) {
+    constexpr size_t HEADER = 7;
+    if (!connected() || HEADER + strlen(topic) + strlen(payload) > bufferSize) return false;
+    if (simBroker.onPublish) simBroker.onPublish({topic, payload, retained});
+    return true;
+}
+
+bool PubSubClient::subscribe(const char *topic, uint8_t) {
+    if (!connected()) return false;
+    simBroker.subscriptions.push_back(topic);
+    return true;
+}
+
+/* Веб-сервер */
+
+void WebServer::send(const int code, const char *type, const String &content) {
+    response.code = code;
+    response.type = type;
+    response.headers = headers;
+    headers.clear();
+    response.body = content.c_str();
+}
+
+void WebServer::send_P(const int code, const char *type, const char *content, const size_t size) {
+    send(code, type, String());
+    response.body.assign(content, size);
+}
+
+void WebServer::sendContent(const char *content, const size_t size) { response.body.append(content, size); }
+
+String WebServer::arg(const char *name) const {
+    const auto value = args.find(name);
+    return value == args.end() ? String() : String(value->second);
+}
+
+WebServer::Response WebServer::simRequest(const HTTPMethod method, const char *path,
+                                          const std::map<std::string, std::string> &fields) {
+    args = fields;
+    response = Response{404, std::string(), {}, std::string()};
+    contentLength = 0;
+    bool found = false;
+    for (const Route &route: routes) {
+        if (route.path != path || (route.method != HTTP_ANY && route.method != method)) continue;
+        route.handler();
+        found = true;
+        break;
+    }
+    if (!found && notFound) notFound();
+    args.clear();
+    return response;
+}
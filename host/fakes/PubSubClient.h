@@ -0,0 +1,41 @@
+#ifndef PUB_SUB_CLIENT_H
+#define PUB_SUB_CLIENT_H
+
+#include <WiFi.h>
+#include <functional>
+
+#define MQTT_CALLBACK_SIGNATURE std::function<void(char *, uint8_t *, unsigned int)> callback
+
+/*
+ * Клиент MQTT поверх simBroker. Публикация, которая не помещается в буфер, отклоняется, как в PubSubClient:
+ * в буфер входят заголовок, топик и данные.
+ */
+class PubSubClient {
+public:
+    explicit PubSubClient(WiFiClient &) {}
+
+    PubSubClient &setServer(const char *, uint16_t) { return *this; }
+    PubSubClient &setCallback(MQTT_CALLBACK_SIGNATURE) {
+        this->callback = callback;
+        return *this;
+    }
+    bool setBufferSize(const uint16_t size) {
+        bufferSize = size;
+        return true;
+    }
+    PubSubClient &setSocketTimeout(uint16_t) { return *this; }
+
+    bool connect(const char *id, const char *user, const char *password);
+    bool connected();
+    bool loop();
+
+    bool publish(const char *topic, const char *payload, bool retained = false);
+    bool subscribe(const char *topic, uint8_t qos = 0);
+
+private:
+    std::function<void(char *, uint8_t *, unsigned int)> callback;
+    uint16_t bufferSize = 256;
+    bool online = false;
+};
+
+#endif
@@ -0,0 +1,119 @@
+#include "Sim.h"
+
+#include <string.h>
+#include <ucontext.h>
+
+SimBoard *simBoard;
+
+SimBoard::SimBoard(const char *name, const uint64_t address) : name(name), address(address) {
+    for (int16_t &level: pinIn) level = -1;
+    // Чистая EEPROM и стёртая страница флеша читаются единицами.
+    memset(eeprom, 0xFF, sizeof(eeprom));
+}
+
+/* Время */
+
+uint64_t simMicros;
+uint32_t simEpoch = 1780272000;
+
+void simAdvance(const uint64_t micros) { simMicros += micros; }
+
+/* Случайность */
+
+std::mt19937 simRandom;
+
+bool simChance(const double probability) {
+    return probability > 0 && std::uniform_real_distribution<double>(0, 1)(simRandom) < probability;
+}
+
+/* Задачи */
+
+constexpr uint8_t STACK_FILL = 0xA5;
+
+struct SimTask {
+    void (*body)(void *);
+    ucontext_t context;
+    ucontext_t caller;
+    std::vector<uint8_t> stack;
+    bool finished;
+};
+
+static SimTask *taskCurrent;
+
+static void taskEntry() {
+    taskCurrent->body(nullptr);
+    simTaskExit();
+}
+
+SimTask *simTaskStart(void (*body)(void *)) {
+    auto *task = new SimTask{body, {}, {}, std::vector<uint8_t>(SIM_TASK_STACK, STACK_FILL), false};
+    getcontext(&task->context);
+    task->context.uc_stack.ss_sp = task->stack.data();
+    task->context.uc_stack.ss_size = task->stack.size();
+    task->context.uc_link = nullptr;
+    makecontext(&task->context, taskEntry, 0);
+    simBoard->tasks.push_back(task);
+    return task;
+}
+
+void simTaskYield() {
+    SimTask *task = taskCurrent;
+    if (!task) return;
+    taskCurrent = nullptr;
+    swapcontext(&task->context, &task->caller);
+}
+
+void simTaskExit() {
+    SimTask *task = taskCurrent;
+    task->finished = true;
+    taskCurrent = nullptr;
+    setcontext(&task->caller);
+    __builtin_unreachable();
+}
+
+SimTask *simTaskCurrent() { return taskCurrent; }
+
+// Стек растёт вниз, поэтому нетронутый заполнитель остаётся у его начала.
+size_t simTaskStackFree(const SimTask *task) {
+    size_t free = 0;
+    while (free < task->stack.size() && task->stack[free] == STACK_FILL) free++;
+    return free;
+}
+
+void simTasksRun() {
+    std::vector<SimTask *> &tasks = simBoard->tasks;
+    for (size_t i = 0; i < tasks.size(); i++) {
+        taskCurrent = tasks[i];
+        swapcontext(&tasks[i]->caller, &tasks[i]->context);
+        taskCurrent = nullptr;
+    }
+    for (size_t i = 0; i < tasks.size();) {
+        if (!tasks[i]->finished) {
+            i++;
+            continue;
+        }
+        delete tasks[i];
+        tasks.erase(tasks.begin() + i);
+    }
+}
+
+/* Облако */
+
+std::function<SimResponse(const std::string &, const std::string &, const std::string &)> simHttp;
+SimWifi simWifi;
+SimBroker simBroker;
+
+bool simTopicMatch(const char *filter, const char *topic) {
+    while (*filter) {
+        if (*filter == '#') return true;
+        if (*filter == '+') {
+            while (*topic && *topic != '/') topic++;
+            filter++;
+            continue;
+        }
+        if (*filter != *topic) return false;
+        filter++;
+        topic++;
+    }
+    return *topic == '\0';
+}
@@ -0,0 +1,148 @@
+#ifndef SIM_H
+#define SIM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <deque>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+ * Мир, в котором прошивки работают на хосте.
+ * Время виртуальное и идёт только по simAdvance(), поэтому сутки работы проходят за секунды.
+ * У каждой платы свои выводы, EEPROM, порты и задачи. Фейки Arduino API обращаются к текущей плате simBoard,
+ * и симулятор переключает её перед вызовом loop() нужной прошивки.
+ * Всё исполняется в одном потоке: задачи FreeRTOS заменены сопрограммами, которые отдают управление
+ * в platformYield(), поэтому прогон с тем же зерном повторяется байт в байт.
+ */
+
+constexpr size_t SIM_PINS = 128;
+constexpr size_t SIM_EEPROM_SIZE = 4096;
+constexpr size_t SIM_TASK_STACK = 256 * 1024;
+
+struct SimTask;
+
+struct SimBoard {
+    const char *name;
+    // Адрес радиомодуля и вывод его сна; -1 — модуль не спит. Координатор отвечает и на нулевой адрес.
+    uint64_t address;
+    bool coordinator = false;
+    int radioSleepPin = -1;
+
+    uint8_t pinModes[SIM_PINS] = {};
+    // Уровни, которые выставила прошивка, и уровни, которыми выводы снаружи управляет модель окружения.
+    uint8_t pinOut[SIM_PINS] = {};
+    int16_t pinIn[SIM_PINS];
+    uint16_t analog[SIM_PINS] = {};
+
+    uint8_t eeprom[SIM_EEPROM_SIZE];
+
+    // UART между МК и радиомодулем в обе стороны и недочитанный модулем кадр.
+    std::deque<uint8_t> radioRx;
+    std::deque<uint8_t> radioTx;
+    std::vector<uint8_t> radioFrame;
+
+    // Двоичный журнал из Serial; читается tools/logdecode.py.
+    FILE *log = nullptr;
+
+    std::vector<SimTask *> tasks;
+    bool restarted = false;
+
+    SimBoard(const char *name, uint64_t address);
+};
+
+extern SimBoard *simBoard;
+
+/* Время */
+
+// Микросекунды от начала прогона и секунды UNIX, с которых он начинается.
+extern uint64_t simMicros;
+extern uint32_t simEpoch;
+
+void simAdvance(uint64_t micros);
+
+inline uint64_t simWallMicros() { return static_cast<uint64_t>(simEpoch) * 1000000 + simMicros; }
+
+/* Случайность */
+
+extern std::mt19937 simRandom;
+
+// true с вероятностью probability.
+bool simChance(double probability);
+
+/* Задачи */
+
+// Сопрограмма текущей платы. Стек у всех один, SIM_TASK_STACK: кадры на хосте крупнее, чем на плате,
+// и размер из прошивки здесь ничего не говорит.
+SimTask *simTaskStart(void (*body)(void *));
+
+// Возвращает управление симулятору до следующего simTasksRun().
+void simTaskYield();
+
+// Завершает текущую задачу; возврата нет.
+[[noreturn]] void simTaskExit();
+
+// Текущая задача или nullptr вне задач.
+SimTask *simTaskCurrent();
+
+// Наименьший запас стека задачи за всё время, в байтах.
+size_t simTaskStackFree(const SimTask *task);
+
+// Даёт каждой задаче текущей платы поработать до её следующей уступки.
+void simTasksRun();
+
+/* Радио */
+
+// Доля кадров, которые теряются в эфире; отправитель узнаёт о потере из статуса передачи.
+extern double simRadioLoss;
+
+// Передаёт в эфир кадры, которые прошивки записали в свои радиопорты.
+void simRadio(const std::vector<SimBoard *> &boards);
+
+/* Облако */
+
+struct SimResponse {
+    int code;
+    std::string body;
+    // Сколько мс сервер держит простаивающее соединение после ответа; 0 — закрывает сразу.
+    // Запрос после закрытия снова начинается с рукопожатия TLS.
+    unsigned long keepAlive;
+};
+
+// Ответ сервера на запрос HTTPS; без обработчика любой запрос получает 404.
+extern std::function<SimResponse(const std::string &method, const std::string &url, const std::string &body)> simHttp;
+
+struct SimWifi {
+    bool available = true;
+    // Этапы подключения в мс: сканирование пропускается с известными каналом и BSSID, DHCP — со статическим адресом.
+    unsigned long scanTime = 2000;
+    unsigned long associateTime = 300;
+    unsigned long dhcpTime = 700;
+};
+
+extern SimWifi simWifi;
+
+struct SimMessage {
+    std::string topic;
+    std::string payload;
+    bool retained;
+};
+
+struct SimBroker {
+    bool online = true;
+    std::vector<std::string> subscriptions;
+    // Команды для хаба; уходят ему по одной за вызов PubSubClient::loop().
+    std::deque<SimMessage> inbox;
+    std::function<void(const SimMessage &message)> onPublish;
+    unsigned long connects = 0;
+};
+
+extern SimBroker simBroker;
+
+// Совпадение топика с фильтром подписки MQTT с подстановками + и #.
+bool simTopicMatch(const char *filter, const char *topic);
+
+#endif
@@ -0,0 +1,62 @@
+#ifndef WEB_SERVER_H
+#define WEB_SERVER_H
+
+#include <WiFi.h>
+#include <functional>
+#include <map>
+#include <utility>
+#include <vector>
+
+typedef enum { HTTP_ANY, HTTP_GET, HTTP_HEAD, HTTP_POST } HTTPMethod;
+
+constexpr size_t CONTENT_LENGTH_UNKNOWN = static_cast<size_t>(-1);
+
+/*
+ * Веб-сервер без сокета: браузер изображает simRequest(), который вызывает обработчик маршрута
+ * и собирает его ответ целиком, вместе с частями chunked-ответа.
+ */
+class WebServer {
+public:
+    explicit WebServer(int = 80) {}
+
+    void on(const char *path, HTTPMethod method, std::function<void()> handler) { routes.push_back({path, method, handler}); }
+    void onNotFound(std::function<void()> handler) { notFound = handler; }
+    void begin() {}
+    void handleClient() {}
+
+    void send(int code, const char *type, const String &content);
+    void send_P(int code, const char *type, const char *content, size_t size);
+    void sendHeader(const char *name, const String &value, bool = false) { headers.push_back({name, value.c_str()}); }
+    void setContentLength(const size_t length) { contentLength = length; }
+    void sendContent(const char *content, size_t size);
+    void sendContent_P(const char *content) { sendContent(content, strlen(content)); }
+
+    bool hasArg(const char *name) const { return args.count(name) > 0; }
+    String arg(const char *name) const;
+
+    struct Response {
+        int code;
+        std::string type;
+        std::vector<std::pair<std::string, std::string>> headers;
+        std::string body;
+    };
+
+    // Только для симулятора: запрос браузера с полями формы.
+    Response simRequest(HTTPMethod method, const char *path, const std::map<std::string, std::string> &args = {});
+
+private:
+    struct Route {
+        std::string path;
+        HTTPMethod method;
+        std::function<void()> handler;
+    };
+
+    std::vector<Route> routes;
+    std::function<void()> notFound;
+    std::map<std::string, std::string> args;
+    std::vector<std::pair<std::string, std::string>> headers;
+    size_t contentLength = 0;
+    Response response;
+};
+
+#endif
@@ -0,0 +1,99 @@
+#ifndef WIFI_H
+#define WIFI_H
+
+#include <Arduino.h>
+
+/*
+ * Станция WiFi и сокеты поверх simWifi. Точка доступа одна; подключение складывается из этапов
+ * simWifi в виртуальных мс, и известные канал с BSSID или статический адрес пропускают свой этап.
+ */
+
+typedef enum {
+    WL_IDLE_STATUS = 0,
+    WL_NO_SSID_AVAIL = 1,
+    WL_CONNECTED = 3,
+    WL_CONNECT_FAILED = 4,
+    WL_DISCONNECTED = 6,
+} wl_status_t;
+
+typedef enum { WIFI_OFF, WIFI_STA, WIFI_AP, WIFI_AP_STA } wifi_mode_t;
+
+// Как на ESP32: первый октет адреса — младший байт числа.
+class IPAddress {
+public:
+    IPAddress() : address(0) {}
+    IPAddress(const uint32_t address) : address(address) {}
+    IPAddress(const uint8_t a, const uint8_t b, const uint8_t c, const uint8_t d)
+        : address(a | b << 8 | c << 16 | static_cast<uint32_t>(d) << 24) {}
+
+    operator uint32_t() const { return address; }
+    uint8_t operator[](const int index) const { return address >> (8 * index); }
+
+    String toString() const {
+        char text[16];
+        snprintf(text, sizeof(text), "%u.%u.%u.%u", (*this)[0], (*this)[1], (*this)[2], (*this)[3]);
+        return String(text);
+    }
+
+private:
+    uint32_t address;
+};
+
+// Сокет с ответом сервера: HTTPClient кладёт в него тело, а прошивка читает его как поток.
+class WiFiClient : public Stream {
+public:
+    int available() override { return body.size() - position; }
+    int read() override { return position < body.size() ? static_cast<uint8_t>(body[position++]) : -1; }
+    int peek() override { return position < body.size() ? static_cast<uint8_t>(body[position]) : -1; }
+    size_t write(uint8_t) override { return 1; }
+
+    virtual uint8_t connected() {
+        if (open && millis() >= closeAt) open = false;
+        return open;
+    }
+    virtual void stop() { open = false; }
+
+    // Только для фейков: HTTPClient открывает соединение, пока есть сеть, и кладёт в сокет ответ сервера.
+    bool simConnect();
+
+    // Тело ответа остаётся в сокете и читается, даже когда сервер уже закрыл соединение.
+    void simRespond(const std::string &text, const unsigned long keepAlive) {
+        body = text;
+        position = 0;
+        closeAt = millis() + keepAlive;
+    }
+
+private:
+    bool open = false;
+    unsigned long closeAt = 0;
+    std::string body;
+    size_t position = 0;
+};
+
+class WiFiClass {
+public:
+    static wl_status_t status();
+
+    wl_status_t begin(const char *ssid, const char *password = nullptr, int32_t channel = 0, const uint8_t *bssid = nullptr,
+                      bool connect = true);
+    bool config(IPAddress ip, IPAddress gateway, IPAddress subnet, IPAddress dns = IPAddress());
+    bool disconnect(bool off = false, bool erase = false);
+
+    bool softAP(const char *ssid, const char *password = nullptr);
+    IPAddress softAPIP() { return IPAddress(192, 168, 4, 1); }
+
+    bool mode(wifi_mode_t) { return true; }
+    bool persistent(bool) { return true; }
+
+    String macAddress() { return String("24:0A:C4:00:00:01"); }
+    uint8_t *BSSID();
+    int32_t channel();
+    IPAddress localIP();
+    IPAddress gatewayIP();
+    IPAddress subnetMask();
+    IPAddress dnsIP(uint8_t = 0);
+};
+
+inline WiFiClass WiFi;
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef WIFI_CLIENT_SECURE_H
+#define WIFI_CLIENT_SECURE_H
+
+#include <WiFi.h>
+
+// TLS на хосте не нужен: сертификаты принимаются, а соединение остаётся обычным сокетом симулятора.
+class WiFiClientSecure : public WiFiClient {
+public:
+    void setCACert(const char *) {}
+    void setHandshakeTimeout(unsigned long) {}
+};
+
+#endif
@@ -0,0 +1,134 @@
+#include "XBee.h"
+
+constexpr uint8_t FRAME_START = 0x7E;
+constexpr uint8_t STATUS_NO_ACK = 0x21;
+constexpr uint8_t STATUS_NOT_FOUND = 0x24;
+
+// Добавляет байт к кадру; true, когда кадр целый и сумма сошлась. Кадр с неверной суммой отбрасывается.
+static bool frameFeed(std::vector<uint8_t> &frame, const uint8_t value) {
+    if (frame.empty() && value != FRAME_START) return false;
+    frame.push_back(value);
+    if (frame.size() < 3) return false;
+    const size_t length = frame[1] << 8 | frame[2];
+    if (frame.size() < length + 4) return false;
+
+    uint8_t sum = 0;
+    for (size_t i = 3; i < frame.size(); i++) sum += frame[i];
+    if (sum == 0xFF) return true;
+    frame.clear();
+    return false;
+}
+
+template<typename Out>
+static void frameWrite(Out &out, const std::vector<uint8_t> &data) {
+    uint8_t sum = 0;
+    for (const uint8_t value: data) sum += value;
+    const uint8_t header[] = {FRAME_START, static_cast<uint8_t>(data.size() >> 8), static_cast<uint8_t>(data.size())};
+    out.insert(out.end(), header, header + sizeof(header));
+    out.insert(out.end(), data.begin(), data.end());
+    out.push_back(0xFF - sum);
+}
+
+static void putAddress(std::vector<uint8_t> &data, const uint64_t address) {
+    for (int shift = 56; shift >= 0; shift -= 8) data.push_back(address >> shift);
+}
+
+static uint64_t getAddress(const uint8_t *data) {
+    uint64_t address = 0;
+    for (int i = 0; i < 8; i++) address = address << 8 | data[i];
+    return address;
+}
+
+/* Библиотека */
+
+void XBeeWithCallbacks::send(ZBTxRequest &request) {
+    std::vector<uint8_t> data = {ZB_TX_REQUEST, request.frameId};
+    putAddress(data, static_cast<uint64_t>(request.address.getMsb()) << 32 | request.address.getLsb());
+    // Сетевой адрес неизвестен, радиус по умолчанию, без опций.
+    data.insert(data.end(), {0xFF, 0xFE, 0x00, 0x00});
+    data.insert(data.end(), request.payload, request.payload + request.length);
+
+    std::vector<uint8_t> bytes;
+    frameWrite(bytes, data);
+    serial->write(bytes.data(), bytes.size());
+}
+
+void XBeeWithCallbacks::loop() {
+    while (serial->available() > 0) {
+        if (!frameFeed(frame, serial->read())) continue;
+        dispatch();
+        frame.clear();
+        return;
+    }
+}
+
+void XBeeWithCallbacks::dispatch() {
+    const uint8_t *data = frame.data() + 3;
+    const size_t length = frame.size() - 4;
+    if (data[0] == ZB_RX_RESPONSE && length >= 12 && rxCallback) {
+        ZBRxResponse response;
+        const uint64_t remote = getAddress(data + 1);
+        response.remote = XBeeAddress64(remote >> 32, remote);
+        response.length = min(length - 12, XBEE_PAYLOAD_MAX);
+        memcpy(response.data, data + 12, response.length);
+        rxCallback(response, rxData);
+    } else if (data[0] == ZB_TX_STATUS_RESPONSE && length >= 7 && statusCallback) {
+        ZBTxStatusResponse response;
+        response.frameId = data[1];
+        response.status = data[5];
+        statusCallback(response, statusData);
+    }
+}
+
+/* Эфир */
+
+double simRadioLoss;
+
+static bool radioAsleep(const SimBoard &board) {
+    return board.radioSleepPin >= 0 && board.pinOut[board.radioSleepPin] == HIGH;
+}
+
+static SimBoard *radioFind(const std::vector<SimBoard *> &boards, const uint64_t address) {
+    for (SimBoard *board: boards) {
+        if (board->address == address || (address == 0 && board->coordinator)) return board;
+    }
+    return nullptr;
+}
+
+// Модуль отправителя принимает кадр от своего МК, передаёт его получателю и сообщает МК статус доставки.
+// Модуль, который спит, кадр не принимает, и отправитель видит отсутствие подтверждения.
+static void radioTransmit(const std::vector<SimBoard *> &boards, SimBoard &from, const std::vector<uint8_t> &frame) {
+    const uint8_t *data = frame.data() + 3;
+    const size_t length = frame.size() - 4;
+    if (data[0] != ZB_TX_REQUEST || length < 14) return;
+
+    SimBoard *to = radioFind(boards, getAddress(data + 2));
+    uint8_t status = SUCCESS;
+    if (!to) {
+        status = STATUS_NOT_FOUND;
+    } else if (radioAsleep(*to) || simChance(simRadioLoss)) {
+        status = STATUS_NO_ACK;
+    } else {
+        std::vector<uint8_t> rx = {ZB_RX_RESPONSE};
+        putAddress(rx, from.address);
+        rx.insert(rx.end(), {0xFF, 0xFE, 0x01});
+        rx.insert(rx.end(), data + 14, data + length);
+        frameWrite(to->radioRx, rx);
+    }
+
+    const uint8_t frameId = data[1];
+    if (frameId == 0) return;
+    frameWrite(from.radioRx, {ZB_TX_STATUS_RESPONSE, frameId, 0xFF, 0xFE, 0x00, status, 0x00});
+}
+
+void simRadio(const std::vector<SimBoard *> &boards) {
+    for (SimBoard *board: boards) {
+        while (!board->radioTx.empty()) {
+            const uint8_t value = board->radioTx.front();
+            board->radioTx.pop_front();
+            if (!frameFeed(board->radioFrame, value)) continue;
+            radioTransmit(boards, *board, board->radioFrame);
+            board->radioFrame.clear();
+        }
+    }
+}
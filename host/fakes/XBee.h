@@ -0,0 +1,111 @@
+#ifndef XBEE_H
+#define XBEE_H
+
+#include <Arduino.h>
+
+/*
+ * Библиотека XBee в режиме API 1: кадры 0x7E, длина, данные и контрольная сумма без экранирования.
+ * МК и модуль говорят через радиопорт платы; модуль и эфир между платами изображает simRadio().
+ * Поддержаны только запрос ZigBee TX (0x10), приём ZigBee RX (0x90) и статус передачи (0x8B).
+ */
+
+constexpr uint8_t ZB_TX_REQUEST = 0x10;
+constexpr uint8_t ZB_RX_RESPONSE = 0x90;
+constexpr uint8_t ZB_TX_STATUS_RESPONSE = 0x8B;
+constexpr uint8_t SUCCESS = 0x00;
+constexpr uint8_t DEFAULT_FRAME_ID = 1;
+constexpr size_t XBEE_PAYLOAD_MAX = 100;
+
+class XBeeAddress64 {
+public:
+    constexpr XBeeAddress64() : msb(0), lsb(0) {}
+    constexpr XBeeAddress64(const uint32_t msb, const uint32_t lsb) : msb(msb), lsb(lsb) {}
+
+    uint32_t getMsb() const { return msb; }
+    uint32_t getLsb() const { return lsb; }
+    void setMsb(const uint32_t value) { msb = value; }
+    void setLsb(const uint32_t value) { lsb = value; }
+
+private:
+    uint32_t msb;
+    uint32_t lsb;
+};
+
+class ZBRxResponse {
+public:
+    uint8_t *getData() { return data; }
+    uint8_t getDataLength() const { return length; }
+    XBeeAddress64 &getRemoteAddress64() { return remote; }
+
+private:
+    friend class XBeeWithCallbacks;
+    XBeeAddress64 remote;
+    uint8_t data[XBEE_PAYLOAD_MAX];
+    uint8_t length = 0;
+};
+
+class ZBTxStatusResponse {
+public:
+    uint8_t getFrameId() const { return frameId; }
+    uint8_t getDeliveryStatus() const { return status; }
+    bool isSuccess() const { return status == SUCCESS; }
+
+private:
+    friend class XBeeWithCallbacks;
+    uint8_t frameId = 0;
+    uint8_t status = SUCCESS;
+};
+
+class ZBTxRequest {
+public:
+    ZBTxRequest(const XBeeAddress64 &address, uint8_t *payload, const uint8_t length)
+        : address(address), payload(payload), length(length) {}
+
+    void setFrameId(const uint8_t value) { frameId = value; }
+    uint8_t getFrameId() const { return frameId; }
+
+private:
+    friend class XBeeWithCallbacks;
+    XBeeAddress64 address;
+    uint8_t *payload;
+    uint8_t length;
+    uint8_t frameId = DEFAULT_FRAME_ID;
+};
+
+class XBeeWithCallbacks {
+public:
+    void setSerial(Stream &stream) { serial = &stream; }
+
+    void send(ZBTxRequest &request);
+
+    // Разбирает байты порта, пока не сложится один кадр, и вызывает его обработчик.
+    void loop();
+
+    uint8_t getNextFrameId() {
+        if (++frameId == 0) frameId = 1;
+        return frameId;
+    }
+
+    void onZBRxResponse(void (*callback)(ZBRxResponse &, uintptr_t), const uintptr_t data = 0) {
+        rxCallback = callback;
+        rxData = data;
+    }
+
+    void onZBTxStatusResponse(void (*callback)(ZBTxStatusResponse &, uintptr_t), const uintptr_t data = 0) {
+        statusCallback = callback;
+        statusData = data;
+    }
+
+private:
+    Stream *serial = nullptr;
+    uint8_t frameId = 0;
+    std::vector<uint8_t> frame;
+    void (*rxCallback)(ZBRxResponse &, uintptr_t) = nullptr;
+    uintptr_t rxData = 0;
+    void (*statusCallback)(ZBTxStatusResponse &, uintptr_t) = nullptr;
+    uintptr_t statusData = 0;
+
+    void dispatch();
+};
+
+#endif
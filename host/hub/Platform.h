@@ -0,0 +1,107 @@
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+#include <EEPROM.h>
+#include <malloc.h>
+#include <sys/time.h>
+
+/*
+ * Платформенно-зависимая часть прошивки хаба для сборки под хост; заменяет Hub/Platform.h,
+ * потому что каталог host/hub стоит в путях поиска раньше Hub.
+ * Файл подключается внутри пространства имён прошивки, поэтому системные заголовки выше
+ * host/sim/Hub.cpp подключает заранее, до этого пространства.
+ */
+
+inline HardwareSerial &radioSerial() { return Serial2; }
+
+constexpr size_t STORAGE_SIZE = SIM_EEPROM_SIZE;
+
+inline void storageBegin(const size_t) { EEPROM.begin(STORAGE_SIZE); }
+
+inline uint8_t storageRead(const size_t address) { return EEPROM.read(address); }
+
+inline void storageWrite(const size_t address, const uint8_t value) { EEPROM.write(address, value); }
+
+inline void storageEnd(const bool commit) {
+    if (commit) EEPROM.commit();
+    EEPROM.end();
+}
+
+// Перезапуск останавливает плату: глобальные переменные прошивки заново не инициализировать.
+inline void platformRestart() { simBoard->restarted = true; }
+
+// Куча glibc общая с симулятором, поэтому её размеры годятся только для сравнения прогонов между собой.
+inline uint32_t platformHeapFree() { return mallinfo2().fordblks; }
+
+inline uint32_t platformHeapLargest() { return mallinfo2().fordblks; }
+
+inline void *platformTask() { return simTaskCurrent(); }
+
+typedef SimTask *PlatformTaskHandle;
+
+// Задача — сопрограмма симулятора; ядро, приоритет и размер стека на хосте ничего не значат.
+inline void platformTaskStart(void (*body)(void *), const char *, const uint32_t, const unsigned int, const int,
+                              PlatformTaskHandle &handle) {
+    handle = simTaskStart(body);
+}
+
+// Отдаёт управление симулятору до его следующего шага.
+inline void platformYield() { simTaskYield(); }
+
+// Завершает вызвавшую задачу; возврата нет.
+inline void platformTaskExit() { simTaskExit(); }
+
+// Наименьший запас стека задачи за всё время, в словах, как у FreeRTOS.
+inline uint32_t platformTaskStack(const PlatformTaskHandle handle) { return simTaskStackFree(handle) / sizeof(uint32_t); }
+
+// Сопрограммы не вытесняют друг друга, поэтому блокировка не нужна.
+class PlatformLock {
+public:
+    void lock() {}
+    void unlock() {}
+};
+
+// Контекст исполнения: радиозадача или loop() с сетью.
+constexpr size_t LOG_CONTEXTS = 2;
+
+inline size_t platformContext() { return simTaskCurrent() ? 0 : 1; }
+
+// ESP_RST_POWERON: прогон всегда начинается с включения.
+inline int platformResetReason() { return 1; }
+
+/* Часы */
+
+// Как на ESP32: время идёт от сброса, пока его не выставит settimeofday() или SNTP.
+// SNTP отвечает через SNTP_DELAY после configTime() и ставит часы по виртуальному времени симулятора.
+constexpr unsigned long SNTP_DELAY = 1000;
+
+inline int64_t clockOffset;
+inline unsigned long clockSntpAt;
+
+inline void configTime(long, int, const char *, const char * = nullptr) { clockSntpAt = max(millis() + SNTP_DELAY, 1ul); }
+
+// Второй параметр — nullptr_t, а не timezone *: так эта перегрузка точнее функции libc, которую находит ADL.
+inline int gettimeofday(timeval *now, std::nullptr_t) {
+    if (clockSntpAt != 0 && millis() >= clockSntpAt) {
+        clockOffset = static_cast<int64_t>(simWallMicros()) - static_cast<int64_t>(micros());
+        clockSntpAt = 0;
+    }
+    const int64_t value = static_cast<int64_t>(micros()) + clockOffset;
+    now->tv_sec = value / 1000000;
+    now->tv_usec = value % 1000000;
+    return 0;
+}
+
+inline int settimeofday(const timeval *value, std::nullptr_t) {
+    clockOffset = value->tv_sec * 1000000ll + value->tv_usec - static_cast<int64_t>(micros());
+    return 0;
+}
+
+inline time_t time(time_t *out) {
+    timeval now;
+    gettimeofday(&now, nullptr);
+    if (out) *out = now.tv_sec;
+    return now.tv_sec;
+}
+
+#endif
@@ -0,0 +1,26 @@
+// Системные заголовки и фейки библиотек подключаются до пространства имён прошивки:
+// их стражи делают повторные #include внутри main.cpp пустыми.
+#include <Arduino.h>
+#include <EEPROM.h>
+#include <XBee.h>
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "Firmware.h"
+
+namespace device {
+#include "../../Device/main.cpp"
+
+uint8_t simZones() { return ZONES; }
+
+void simSoil(const uint8_t zone, const uint16_t raw) { simBoard->analog[PIN_MOIST[zone]] = raw; }
+
+bool simValve(const uint8_t zone) { return simBoard->pinOut[PIN_VALVE[zone]] == HIGH; }
+
+// Датчик воды замыкает вывод на землю, пока вода есть.
+void simWater(const bool available) { simBoard->pinIn[PIN_WATER] = available ? LOW : HIGH; }
+
+int simRadioSleepPin() { return PIN_XBEE_SLEEP; }
+}
@@ -0,0 +1,36 @@
+#ifndef FIRMWARE_H
+#define FIRMWARE_H
+
+#include <stdint.h>
+#include <string>
+
+/*
+ * Обе прошивки собираются в один исполняемый файл, каждая в своём пространстве имён:
+ * у них одинаковые setup(), loop(), config и заголовки с одинаковыми стражами.
+ * Функции sim* дописаны к прошивкам в Device.cpp и Hub.cpp и дают симулятору доступ к ним.
+ */
+
+namespace device {
+void setup();
+void loop();
+
+uint8_t simZones();
+// Сырое значение АЦП датчика влажности зоны.
+void simSoil(uint8_t zone, uint16_t raw);
+bool simValve(uint8_t zone);
+void simWater(bool available);
+int simRadioSleepPin();
+}
+
+namespace hub {
+void setup();
+void loop();
+
+// Записывает в EEPROM хаба настройки, которые на плате вводятся через портал; вызывается до setup().
+// legacy — в раскладке прошивок до журнального хранилища, как на плате после обновления.
+void simProvision(const char *ssid, const char *token, float latitude, float longitude, bool legacy);
+// Ответ хаба на GET /metrics.
+std::string simMetrics();
+}
+
+#endif
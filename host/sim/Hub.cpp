@@ -0,0 +1,54 @@
+// Системные заголовки и фейки библиотек подключаются до пространства имён прошивки:
+// их стражи делают повторные #include внутри main.cpp и host/hub/Platform.h пустыми.
+#include <Arduino.h>
+#include <ArduinoJson.h>
+#include <EEPROM.h>
+#include <HTTPClient.h>
+#include <PubSubClient.h>
+#include <WiFi.h>
+#include <WiFiClientSecure.h>
+#include <WebServer.h>
+#include <XBee.h>
+#include <atomic>
+#include <malloc.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "Firmware.h"
+
+namespace hub {
+#include "../../Hub/main.cpp"
+
+// Старая прошивка писала Config целиком с адреса 0, и новая переносит его при первой загрузке.
+void simProvisionLegacy(const char *ssid, const char *token, const float latitude, const float longitude) {
+    LegacyConfig legacy;
+    memset(&legacy, 0, sizeof(legacy));
+    strlcpy(legacy.WIFI_SSID, ssid, sizeof(legacy.WIFI_SSID));
+    strlcpy(legacy.WQTT_TOKEN, token, sizeof(legacy.WQTT_TOKEN));
+    legacy.WEATHER_LATITUDE = latitude;
+    legacy.WEATHER_LONGITUDE = longitude;
+
+    const auto bytes = reinterpret_cast<const uint8_t *>(&legacy);
+    storageBegin(sizeof(legacy));
+    for (size_t i = 0; i < sizeof(legacy); i++) storageWrite(i, bytes[i]);
+    storageEnd(true);
+}
+
+void simProvision(const char *ssid, const char *token, const float latitude, const float longitude,
+                  const bool legacy) {
+    if (legacy) return simProvisionLegacy(ssid, token, latitude, longitude);
+
+    loadConfig();
+    strlcpy(config.WIFI_SSID, ssid, sizeof(config.WIFI_SSID));
+    config.WIFI_PASSWORD[0] = '\0';
+    strlcpy(config.WQTT_TOKEN, token, sizeof(config.WQTT_TOKEN));
+    config.WEATHER_LATITUDE = latitude;
+    config.WEATHER_LONGITUDE = longitude;
+    saveConfig();
+    configStore.flush();
+}
+
+std::string simMetrics() { return webServer.simRequest(HTTP_GET, "/metrics").body; }
+}
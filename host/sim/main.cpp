@@ -0,0 +1,230 @@
+/*
+ * Симулятор системы полива: устройство и хаб на общем виртуальном времени, радио между ними — simRadio(),
+ * облако — заготовленные ответы брокера, регистрации и прогноза. Публикации хаба печатаются с временем
+ * от начала прогона, а двоичные журналы плат с --log пишутся в файлы для tools/logdecode.py.
+ *
+ *   sim [--hours N] [--step MS] [--loss P] [--seed N] [--log DIR] [--quiet] [--legacy]
+ *       [--command SECONDS:TOPIC=PAYLOAD]...
+ *
+ * С --legacy настройки хаба лежат в старой раскладке EEPROM, как после обновления прошивки.
+ *
+ * Например, уставка 40% для первой зоны через десять минут после старта:
+ *   sim --hours 24 --command 600:41000001/1/moisture/reference=40
+ */
+
+#include <getopt.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+#include <Arduino.h>
+
+#include "Firmware.h"
+
+constexpr uint64_t DEVICE_ADDRESS = 0x0013A20041000001ull;
+constexpr uint64_t HUB_ADDRESS = 0x0013A20040000000ull;
+
+/* Растения */
+
+constexpr float SOIL_START = 35;
+// Проценты влажности в час без полива, в минуту с открытым клапаном и в час на 0.1 мм/ч дождя.
+constexpr float SOIL_DRYING = 1.5f;
+constexpr float SOIL_WATERING = 4;
+constexpr float SOIL_RAIN = 0.5f;
+constexpr int SOIL_NOISE = 4;
+constexpr int ADC_FULL = 1023;
+
+// Дождь по часам суток в 0.1 мм/ч: прогноз сервера и модель почвы берут его отсюда.
+uint8_t rainAt(const uint64_t wallSeconds) {
+    const unsigned int hour = wallSeconds / 3600 % 24;
+    return hour >= 15 && hour < 17 ? 20 : 0;
+}
+
+// Влажность зон в процентах.
+typedef std::vector<float> Plant;
+
+void plantStep(Plant &plant, const uint64_t stepMicros) {
+    const float hours = stepMicros / 3.6e9f;
+    const uint8_t rain = rainAt(simWallMicros() / 1000000);
+    for (uint8_t zone = 0; zone < plant.size(); zone++) {
+        float &moisture = plant[zone];
+        moisture -= SOIL_DRYING * hours;
+        moisture += SOIL_RAIN * rain * hours;
+        if (device::simValve(zone)) moisture += SOIL_WATERING * 60 * hours;
+        moisture = constrain(moisture, 0.0f, 100.0f);
+
+        const int noise = random(-SOIL_NOISE, SOIL_NOISE + 1);
+        device::simSoil(zone, constrain(static_cast<int>(lroundf(moisture * ADC_FULL / 100)) + noise, 0, ADC_FULL));
+    }
+}
+
+/* Облако */
+
+unsigned long devicesRegistered;
+
+std::string forecastJson() {
+    const uint64_t now = simWallMicros() / 1000000;
+    const uint64_t start = now - now % 3600;
+    std::string times;
+    std::string rain;
+    for (int hour = 0; hour < 24; hour++) {
+        char value[32];
+        snprintf(value, sizeof(value), "%s%llu", hour > 0 ? "," : "", static_cast<unsigned long long>(start + hour * 3600));
+        times += value;
+        snprintf(value, sizeof(value), "%s%.1f", hour > 0 ? "," : "", rainAt(start + hour * 3600) / 10.0);
+        rain += value;
+    }
+    return "{\"latitude\":55.75,\"longitude\":37.62,\"current\":{\"time\":" + std::to_string(now) +
+           ",\"rain\":0.0},\"hourly\":{\"time\":[" + times + "],\"rain\":[" + rain + "]}}";
+}
+
+// Оба сервера держат соединение минуту простоя, как nginx по умолчанию: запросы подряд к WQTT идут по одному
+// соединению, а ежечасный прогноз каждый раз начинается с рукопожатия.
+constexpr unsigned long CLOUD_KEEP_ALIVE = 1000ul * 60ul;
+
+SimResponse cloud(const std::string &method, const std::string &url, const std::string &) {
+    if (url.find("/api/broker") != std::string::npos) {
+        return {200, "{\"server\":\"broker.sim\",\"port\":1883,\"user\":\"hub\",\"password\":\"secret\"}",
+                CLOUD_KEEP_ALIVE};
+    }
+    if (url.find("/api/devices") != std::string::npos && method == "POST") {
+        return {200, "{\"detail\":{\"device_id\":" + std::to_string(++devicesRegistered) + "}}", CLOUD_KEEP_ALIVE};
+    }
+    if (url.find("api.open-meteo.com") != std::string::npos) return {200, forecastJson(), CLOUD_KEEP_ALIVE};
+    return {404, "{}", CLOUD_KEEP_ALIVE};
+}
+
+/* Прогон */
+
+struct Command {
+    uint64_t at;
+    SimMessage message;
+};
+
+std::string elapsed(const uint64_t micros) {
+    const uint64_t seconds = micros / 1000000;
+    char text[32];
+    snprintf(text, sizeof(text), "%llu+%02llu:%02llu:%02llu", static_cast<unsigned long long>(seconds / 86400),
+             static_cast<unsigned long long>(seconds / 3600 % 24), static_cast<unsigned long long>(seconds / 60 % 60),
+             static_cast<unsigned long long>(seconds % 60));
+    return text;
+}
+
+bool commandParse(const char *text, Command &command) {
+    const char *colon = strchr(text, ':');
+    const char *equals = colon ? strchr(colon, '=') : nullptr;
+    if (!colon || !equals) return false;
+    command.at = strtoull(text, nullptr, 10) * 1000000;
+    command.message = {std::string(colon + 1, equals), equals + 1, false};
+    return true;
+}
+
+FILE *logOpen(const std::string &directory, const char *name) {
+    if (directory.empty()) return nullptr;
+    const std::string path = directory + "/" + name + ".log";
+    FILE *file = fopen(path.c_str(), "wb");
+    if (!file) perror(path.c_str());
+    return file;
+}
+
+int usage() {
+    fprintf(stderr, "usage: sim [--hours N] [--step MS] [--loss P] [--seed N] [--log DIR] [--quiet] [--legacy] "
+                    "[--command SECONDS:TOPIC=PAYLOAD]...\n");
+    return 2;
+}
+
+int main(int argc, char **argv) {
+    double hours = 24;
+    unsigned long step = 10;
+    unsigned long seed = 1;
+    bool quiet = false;
+    bool legacy = false;
+    std::string logDirectory;
+    std::vector<Command> commands;
+
+    const option options[] = {
+        {"hours", required_argument, nullptr, 'h'}, {"step", required_argument, nullptr, 's'},
+        {"loss", required_argument, nullptr, 'l'},  {"seed", required_argument, nullptr, 'r'},
+        {"log", required_argument, nullptr, 'o'},   {"quiet", no_argument, nullptr, 'q'},
+        {"legacy", no_argument, nullptr, 'g'},      {"command", required_argument, nullptr, 'c'},
+        {nullptr, 0, nullptr, 0},
+    };
+    for (int option; (option = getopt_long(argc, argv, "", options, nullptr)) != -1;) {
+        Command command;
+        switch (option) {
+            case 'h': hours = atof(optarg); break;
+            case 's': step = max(strtoul(optarg, nullptr, 10), 1ul); break;
+            case 'l': simRadioLoss = atof(optarg); break;
+            case 'r': seed = strtoul(optarg, nullptr, 10); break;
+            case 'o': logDirectory = optarg; break;
+            case 'q': quiet = true; break;
+            case 'g': legacy = true; break;
+            case 'c':
+                if (!commandParse(optarg, command)) return usage();
+                commands.push_back(command);
+                break;
+            default: return usage();
+        }
+    }
+    simRandom.seed(seed);
+
+    unsigned long published = 0;
+    simHttp = cloud;
+    simBroker.onPublish = [&](const SimMessage &message) {
+        published++;
+        if (!quiet) printf("%s %s %s\n", elapsed(simMicros).c_str(), message.topic.c_str(), message.payload.c_str());
+    };
+
+    SimBoard deviceBoard("device", DEVICE_ADDRESS);
+    SimBoard hubBoard("hub", HUB_ADDRESS);
+    hubBoard.coordinator = true;
+    deviceBoard.radioSleepPin = device::simRadioSleepPin();
+    deviceBoard.log = logOpen(logDirectory, deviceBoard.name);
+    hubBoard.log = logOpen(logDirectory, hubBoard.name);
+    const std::vector<SimBoard *> boards = {&deviceBoard, &hubBoard};
+
+    Plant plant(device::simZones(), SOIL_START);
+
+    simBoard = &deviceBoard;
+    device::simWater(true);
+    plantStep(plant, 0);
+    device::setup();
+
+    simBoard = &hubBoard;
+    hub::simProvision("garden", "token", 55.75f, 37.62f, legacy);
+    hub::setup();
+
+    const uint64_t duration = static_cast<uint64_t>(hours * 3.6e9);
+    const uint64_t stepMicros = step * 1000ull;
+    while (simMicros < duration && !hubBoard.restarted) {
+        for (const Command &command: commands) {
+            if (command.at >= simMicros && command.at < simMicros + stepMicros) simBroker.inbox.push_back(command.message);
+        }
+
+        simBoard = &deviceBoard;
+        plantStep(plant, stepMicros);
+        device::loop();
+        simRadio(boards);
+
+        simBoard = &hubBoard;
+        hub::loop();
+        simTasksRun();
+        simRadio(boards);
+
+        simAdvance(stepMicros);
+    }
+
+    simBoard = &hubBoard;
+    printf("%s done: %lu publications, %lu broker connects, %lu devices registered\n", elapsed(simMicros).c_str(),
+           published, simBroker.connects, devicesRegistered);
+    for (size_t zone = 0; zone < plant.size(); zone++) printf("zone %zu moisture %.1f%%\n", zone + 1, plant[zone]);
+    printf("metrics %s\n", hub::simMetrics().c_str());
+
+    for (SimBoard *board: boards) {
+        if (board->log) fclose(board->log);
+    }
+    return 0;
+}
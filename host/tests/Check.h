@@ -0,0 +1,23 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <stdio.h>
+
+/*
+ * Проверки тестов хоста. В отличие от assert(), не исчезают при NDEBUG и не останавливают тест:
+ * каждая неудача печатается, а CHECK_RESULT в конце main() превращает их число в код возврата для ctest.
+ */
+
+inline int checkFailures;
+
+#define CHECK(condition)                                                               \
+    do {                                                                               \
+        if (!(condition)) {                                                            \
+            fprintf(stderr, "%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #condition); \
+            checkFailures++;                                                           \
+        }                                                                              \
+    } while (0)
+
+#define CHECK_RESULT() (checkFailures == 0 ? 0 : 1)
+
+#endif
@@ -0,0 +1,224 @@
+#include <Arduino.h>
+#include <EEPROM.h>
+
+#include "Check.h"
+
+/*
+ * Память — EEPROM платы симулятора. Питание пропадает посреди записи, когда кончается writeBudget:
+ * дальнейшие байты не доходят до памяти, как при оборванном commit().
+ */
+
+long writeBudget = -1;
+
+inline void storageBegin(const size_t) { EEPROM.begin(); }
+
+inline uint8_t storageRead(const size_t address) { return EEPROM.read(address); }
+
+inline void storageWrite(const size_t address, const uint8_t value) {
+    if (writeBudget == 0) return;
+    if (writeBudget > 0) writeBudget--;
+    EEPROM.write(address, value);
+}
+
+inline void storageEnd(const bool) { EEPROM.end(); }
+
+#include "../../Common/ConfigStore.h"
+
+struct Settings {
+    uint32_t interval;
+    uint8_t zones[8];
+};
+
+constexpr size_t SLOTS = 3;
+typedef ConfigStore<Settings, 1, SLOTS> Store;
+
+void boardReset(SimBoard &board) {
+    memset(board.eeprom, 0xFF, sizeof(board.eeprom));
+    writeBudget = -1;
+}
+
+void testEmpty(SimBoard &board) {
+    boardReset(board);
+    Settings settings = {};
+    Store store(settings);
+    CHECK(!store.load());
+    CHECK(store.writes() == 0);
+}
+
+// Запись идёт по слотам по кругу, а загрузка берёт самую свежую.
+void testRotation(SimBoard &board) {
+    boardReset(board);
+    Settings settings = {};
+    Store store(settings);
+    store.load();
+    for (uint32_t i = 1; i <= 7; i++) {
+        settings.interval = i;
+        store.commit();
+    }
+
+    Settings loaded = {};
+    Store reader(loaded);
+    CHECK(reader.load());
+    CHECK(loaded.interval == 7);
+    CHECK(reader.writes() == 7);
+
+    // Следующая запись продолжает круг с того же места.
+    loaded.interval = 8;
+    reader.commit();
+    Settings again = {};
+    Store check(again);
+    CHECK(check.load());
+    CHECK(again.interval == 8);
+}
+
+// Оборванная на любом байте запись оставляет целой предыдущую.
+void testTornWrite(SimBoard &board) {
+    for (long budget = 0; budget < static_cast<long>(Store::SLOT_SIZE); budget++) {
+        boardReset(board);
+        Settings settings = {};
+        Store store(settings);
+        store.load();
+        settings.interval = 100;
+        store.commit();
+        settings.interval = 200;
+        store.commit();
+
+        writeBudget = budget;
+        settings.interval = 300;
+        store.commit();
+        writeBudget = -1;
+
+        Settings loaded = {};
+        Store reader(loaded);
+        CHECK(reader.load());
+        CHECK(loaded.interval == 200);
+        CHECK(reader.writes() == 2);
+    }
+}
+
+// Испорченный байт данных отвергается по CRC.
+void testCorruption(SimBoard &board) {
+    boardReset(board);
+    Settings settings = {};
+    Store store(settings);
+    store.load();
+    settings.interval = 1;
+    store.commit();
+    settings.interval = 2;
+    store.commit();
+    board.eeprom[Store::SLOT_SIZE + sizeof(ConfigRecord)] ^= 0x01;
+
+    Settings loaded = {};
+    Store reader(loaded);
+    CHECK(reader.load());
+    CHECK(loaded.interval == 1);
+}
+
+// Запись другой схемы или размера не читается как своя.
+void testSchema(SimBoard &board) {
+    boardReset(board);
+    Settings settings = {7, {}};
+    Store store(settings);
+    store.load();
+    store.commit();
+
+    Settings loaded = {};
+    ConfigStore<Settings, 2, SLOTS> other(loaded);
+    CHECK(!other.load());
+}
+
+// Номер записи сравнивается с переполнением: после 0xFFFFFFFF свежее 0.
+void testSequenceWrap(SimBoard &board) {
+    boardReset(board);
+    Settings settings = {};
+    Store store(settings);
+    store.load();
+    store.commit();
+
+    ConfigRecord record;
+    memcpy(&record, board.eeprom, sizeof(record));
+    record.sequence = 0xFFFFFFFF;
+    memcpy(board.eeprom, &record, sizeof(record));
+    const uint16_t crc = crc16(&settings, sizeof(settings), crc16(&record, sizeof(record)));
+    memcpy(board.eeprom + sizeof(record) + sizeof(settings), &crc, sizeof(crc));
+
+    Settings loaded = {};
+    Store reader(loaded);
+    CHECK(reader.load());
+    loaded.interval = 42;
+    reader.commit();
+    CHECK(reader.writes() == 0);
+
+    Settings again = {};
+    Store check(again);
+    CHECK(check.load());
+    CHECK(again.interval == 42);
+}
+
+void testErase(SimBoard &board) {
+    boardReset(board);
+    Settings settings = {};
+    Store store(settings);
+    store.load();
+    store.commit();
+    store.erase();
+
+    Store reader(settings);
+    CHECK(!reader.load());
+}
+
+// Старая структура с начала области не читается как запись, но доступна для переноса; первая запись журнала
+// ложится поверх неё.
+void testLegacy(SimBoard &board) {
+    boardReset(board);
+    const Settings old = {30, {1, 2, 3}};
+    memcpy(board.eeprom + 16, &old, sizeof(old));
+
+    Settings settings = {};
+    ConfigStore<Settings, 1, SLOTS, 16> store(settings);
+    CHECK(!store.load());
+    Settings legacy = {};
+    store.loadLegacy(legacy);
+    CHECK(memcmp(&legacy, &old, sizeof(old)) == 0);
+
+    settings = legacy;
+    store.commit();
+    Settings loaded = {};
+    ConfigStore<Settings, 1, SLOTS, 16> reader(loaded);
+    CHECK(reader.load());
+    CHECK(loaded.interval == 30 && loaded.zones[2] == 3);
+}
+
+// Отложенное сохранение: серия изменений — одна запись через delay после первого из них.
+void testDeferred(SimBoard &board) {
+    boardReset(board);
+    Settings settings = {};
+    Store store(settings);
+    store.load();
+    for (int i = 0; i < 5; i++) {
+        store.save();
+        store.task(1000);
+        delay(100);
+    }
+    CHECK(store.pending());
+    CHECK(store.writes() == 0);
+    delay(600);
+    store.task(1000);
+    CHECK(!store.pending());
+    CHECK(store.writes() == 1);
+}
+
+int main() {
+    SimBoard board("store", 0);
+    simBoard = &board;
+    testEmpty(board);
+    testRotation(board);
+    testTornWrite(board);
+    testCorruption(board);
+    testSchema(board);
+    testSequenceWrap(board);
+    testErase(board);
+    testDeferred(board);
+    testLegacy(board);
+    return CHECK_RESULT();
+}
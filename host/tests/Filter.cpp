@@ -0,0 +1,49 @@
+#include "../../Device/Filter.h"
+#include "Check.h"
+
+void testMedian() {
+    Channel channel = {};
+    const uint16_t raws[] = {500, 10, 20, 1000, 30};
+    for (const uint16_t raw: raws) channelSample(channel, raw);
+    CHECK(channel.count == FILTER_WINDOW);
+    CHECK(channelMedian(channel) == 30);
+
+    // Неполное окно: медиана по тем отсчётам, что есть.
+    Channel partial = {};
+    channelSample(partial, 300);
+    CHECK(channelMedian(partial) == 300);
+    channelSample(partial, 100);
+    channelSample(partial, 200);
+    CHECK(channelMedian(partial) == 200);
+}
+
+// Первый отсчёт принимается как есть, одиночный выброс медиана не пропускает.
+void testSpike() {
+    Channel channel = {};
+    channelSample(channel, 400);
+    CHECK(channel.filtered == 400 * FILTER_SCALE);
+    for (int i = 0; i < 10; i++) channelSample(channel, 400);
+    channelSample(channel, 1023);
+    CHECK(channel.filtered == 400 * FILTER_SCALE);
+}
+
+// После ступеньки сглаженное значение сходится к новому уровню, не перескакивая его.
+void testStep() {
+    Channel channel = {};
+    for (int i = 0; i < FILTER_WINDOW; i++) channelSample(channel, 200);
+    int32_t previous = channel.filtered;
+    for (int i = 0; i < 60; i++) {
+        channelSample(channel, 600);
+        CHECK(channel.filtered >= previous);
+        CHECK(channel.filtered <= 600 * FILTER_SCALE);
+        previous = channel.filtered;
+    }
+    CHECK(600 * FILTER_SCALE - channel.filtered < FILTER_SCALE * FILTER_SMOOTHING);
+}
+
+int main() {
+    testMedian();
+    testSpike();
+    testStep();
+    return CHECK_RESULT();
+}
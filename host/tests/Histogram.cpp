@@ -0,0 +1,31 @@
+#include "../../Hub/Histogram.h"
+#include "Check.h"
+
+constexpr uint32_t BOUNDS[] = {10, 100, 1000};
+
+// Граница входит в свою корзину, всё выше последней — в корзину переполнения.
+void testBuckets() {
+    Histogram<3> histogram(BOUNDS);
+    CHECK(histogram.buckets() == 4);
+    const uint32_t values[] = {0, 10, 11, 100, 101, 1000, 1001, 5000};
+    for (const uint32_t value: values) histogram.record(value);
+    CHECK(histogram.count(0) == 2);
+    CHECK(histogram.count(1) == 2);
+    CHECK(histogram.count(2) == 2);
+    CHECK(histogram.count(3) == 2);
+    CHECK(histogram.total() == 8);
+    CHECK(histogram.maximum() == 5000);
+}
+
+void testEmpty() {
+    const Histogram<3> histogram(BOUNDS);
+    for (size_t bucket = 0; bucket < histogram.buckets(); bucket++) CHECK(histogram.count(bucket) == 0);
+    CHECK(histogram.total() == 0);
+    CHECK(histogram.maximum() == 0);
+}
+
+int main() {
+    testBuckets();
+    testEmpty();
+    return CHECK_RESULT();
+}
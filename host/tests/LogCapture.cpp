@@ -0,0 +1,47 @@
+/*
+ * Пишет в файл журнал, каким его отдаёт прошивка: записи через logWrite()/logDrain() в Serial
+ * вперемешку с текстом загрузчика и одной испорченной записью. Разбор проверяет logdecode_test.py.
+ */
+
+#include <Arduino.h>
+
+constexpr size_t LOG_CONTEXTS = 1;
+
+inline size_t platformContext() { return 0; }
+
+#include "../../Common/Log.h"
+
+int main(int argc, char **argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: logcapture FILE\n");
+        return 2;
+    }
+    SimBoard board("log", 0);
+    simBoard = &board;
+    board.log = fopen(argv[1], "wb");
+    if (!board.log) {
+        perror(argv[1]);
+        return 1;
+    }
+
+    Serial.print("ets Jun  8 2016 00:22:57\r\n");
+    delay(1234);
+    LOG_INFO(LOG_CONFIG_LOADED);
+    LOG_INFO(LOG_NODE_LEARNED, 0x41000001);
+    LOG_WARN(LOG_MQTT_RANGE, -5, 3);
+    logDrain(Serial);
+
+    // Запись с неверной суммой выводится как сырые байты и не сбивает разбор следующей.
+    const LogRecord broken = {LOG_CONFIG_LOADED, LOG_LEVEL_ERROR, 0, 0, {}};
+    uint8_t buffer[9 + 4 * LOG_ARGS_MAX];
+    const size_t length = logEncode(broken, buffer);
+    buffer[length - 1]++;
+    Serial.write(buffer, length);
+
+    delay(1000);
+    LOG_ERROR(LOG_BOOT, 120, 3000, 3010, 1);
+    logDrain(Serial);
+
+    fclose(board.log);
+    return 0;
+}
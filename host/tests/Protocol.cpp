@@ -0,0 +1,21 @@
+#include "../../Common/Protocol.h"
+#include "Check.h"
+
+void testSeqBefore() {
+    CHECK(seqBefore(1, 2));
+    CHECK(!seqBefore(2, 1));
+    CHECK(!seqBefore(5, 5));
+    // Через переполнение: 65535 раньше 0, а 0 позже.
+    CHECK(seqBefore(65535, 0));
+    CHECK(!seqBefore(0, 65535));
+    CHECK(seqBefore(65530, 10));
+    // Сравнение верно на расстоянии меньше половины круга и переворачивается за ней.
+    CHECK(seqBefore(0, 32767));
+    CHECK(!seqBefore(0, 32769));
+    CHECK(seqBefore(40000, static_cast<uint16_t>(40000 + 32767)));
+}
+
+int main() {
+    testSeqBefore();
+    return CHECK_RESULT();
+}
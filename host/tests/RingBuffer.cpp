@@ -0,0 +1,54 @@
+#include "../../Common/RingBuffer.h"
+#include "Check.h"
+
+void testOrder() {
+    RingBuffer<int, 4> buffer;
+    CHECK(buffer.empty());
+    for (int i = 1; i <= 3; i++) CHECK(buffer.push(i));
+    CHECK(buffer.size() == 3);
+    CHECK(!buffer.full());
+    CHECK(buffer.front() == 1);
+    CHECK(buffer.back() == 3);
+    CHECK(buffer[1] == 2);
+}
+
+// Переполнение вытесняет самый старый элемент и сообщает об этом.
+void testOverwrite() {
+    RingBuffer<int, 4> buffer;
+    for (int i = 1; i <= 4; i++) CHECK(buffer.push(i));
+    CHECK(buffer.full());
+    CHECK(!buffer.push(5));
+    CHECK(buffer.size() == 4);
+    CHECK(buffer.front() == 2);
+    CHECK(buffer.back() == 5);
+    for (size_t i = 0; i < buffer.size(); i++) CHECK(buffer[i] == static_cast<int>(i) + 2);
+}
+
+// Индексы идут от хвоста и после многих оборотов.
+void testWrap() {
+    RingBuffer<int, 3> buffer;
+    for (int i = 0; i < 100; i++) {
+        buffer.push(i);
+        if (i % 2 == 0) buffer.pop();
+    }
+    CHECK(buffer.size() == 3);
+    CHECK(buffer.front() == 97);
+    CHECK(buffer[2] == 99);
+
+    buffer.pop();
+    buffer.pop();
+    buffer.pop();
+    buffer.pop();
+    CHECK(buffer.empty());
+
+    buffer.push(7);
+    buffer.clear();
+    CHECK(buffer.empty());
+}
+
+int main() {
+    testOrder();
+    testOverwrite();
+    testWrap();
+    return CHECK_RESULT();
+}
@@ -0,0 +1,76 @@
+#include <thread>
+
+#include "../../Common/SpscQueue.h"
+#include "Check.h"
+
+// Полная очередь отказывает производителю, а не вытесняет старое.
+void testFull() {
+    SpscQueue<int, 4> queue;
+    CHECK(queue.empty());
+    for (int i = 0; i < 4; i++) CHECK(queue.push(i));
+    CHECK(!queue.push(4));
+    CHECK(queue.size() == 4);
+    CHECK(queue.space() == 0);
+    CHECK(queue.front() == 0);
+
+    queue.pop();
+    CHECK(queue.push(4));
+    for (int i = 1; i <= 4; i++) {
+        CHECK(queue.front() == i);
+        queue.pop();
+    }
+    CHECK(queue.empty());
+    queue.pop();
+    CHECK(queue.size() == 0);
+    CHECK(queue.highWater() == 4);
+}
+
+// Счётчики не сбрасываются и переходят через ёмкость много раз.
+void testWrap() {
+    SpscQueue<int, 2> queue;
+    for (int i = 0; i < 1000; i++) {
+        CHECK(queue.push(i));
+        CHECK(queue.front() == i);
+        queue.pop();
+    }
+    CHECK(queue.empty());
+    CHECK(queue.highWater() == 1);
+}
+
+// Производитель и потребитель в разных потоках: всё доходит по порядку и без потерь.
+void testThreads() {
+    constexpr int COUNT = 200000;
+    SpscQueue<int, 16> queue;
+    std::thread producer([&queue] {
+        for (int i = 0; i < COUNT;) {
+            if (queue.push(i)) {
+                i++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    int expected = 0;
+    bool ordered = true;
+    while (expected < COUNT) {
+        if (queue.empty()) {
+            std::this_thread::yield();
+            continue;
+        }
+        ordered &= queue.front() == expected;
+        queue.pop();
+        expected++;
+    }
+    producer.join();
+    CHECK(ordered);
+    CHECK(queue.empty());
+    CHECK(queue.highWater() <= queue.capacity());
+}
+
+int main() {
+    testFull();
+    testWrap();
+    testThreads();
+    return CHECK_RESULT();
+}
@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+"""Проверяет tools/logdecode.py на журнале, который пишет logcapture из Common/Log.h.
+
+    python3 logdecode_test.py path/to/logcapture
+"""
+
+import subprocess
+import sys
+import tempfile
+import unittest
+from pathlib import Path
+
+sys.path.insert(0, str(Path(__file__).resolve().parents[2] / "tools"))
+import logdecode  # noqa: E402
+
+CAPTURE = None
+
+EXPECTED = [
+    "ets Jun  8 2016 00:22:57",
+    "     1.234 INFO  Config loaded.",
+    "     1.234 INFO  Node learned: 41000001",
+    "     1.234 WARN  MQTT value -5 out of range for signal 3.",
+    "     2.234 ERROR Boot: radio=120ms wifi=3000ms mqtt=3010ms fast=1",
+]
+
+
+class LogDecodeTest(unittest.TestCase):
+    @classmethod
+    def setUpClass(cls):
+        with tempfile.TemporaryDirectory() as directory:
+            path = Path(directory) / "capture.bin"
+            subprocess.run([CAPTURE, str(path)], check=True)
+            cls.data = path.read_bytes()
+        cls.texts = logdecode.messages()
+
+    def decoded(self, chunk):
+        lines = []
+        pending = b""
+        for start in range(0, len(self.data), chunk):
+            found, pending = logdecode.decode(pending + self.data[start:start + chunk], self.texts)
+            lines += found
+        return [line for line in lines if line], pending
+
+    def test_whole(self):
+        lines, pending = self.decoded(len(self.data))
+        self.assertEqual(pending, b"")
+        self.assertEqual([line for line in lines if line in EXPECTED], EXPECTED)
+        # Испорченная запись осталась сырыми байтами между верными.
+        self.assertEqual(len(lines), len(EXPECTED) + 1)
+        self.assertNotIn("Config loaded.", lines[-2])
+
+    def test_byte_by_byte(self):
+        # С порта данные приходят кусками: запись, разорванная между ними, собирается целиком.
+        lines, pending = self.decoded(1)
+        self.assertEqual(pending, b"")
+        self.assertEqual([line for line in lines if line in EXPECTED], EXPECTED[1:])
+
+
+if __name__ == "__main__":
+    CAPTURE = sys.argv.pop(1)
+    unittest.main()
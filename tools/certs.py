@@ -0,0 +1,35 @@
+#!/usr/bin/env python3
+"""Собирает Hub/Certificates.h — корневые сертификаты, которыми хаб проверяет HTTPS.
+
+Хаб ходит к dash.wqtt.ru и api.open-meteo.com; их цепочки выпускают Let's Encrypt
+(ISRG) и Google Trust Services. Корни берутся из системного хранилища:
+    python3 tools/certs.py [каталог сертификатов]
+"""
+
+import sys
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+OUTPUT = ROOT / "Hub" / "Certificates.h"
+
+ROOTS = ["ISRG_Root_X1", "ISRG_Root_X2", "GTS_Root_R1", "GTS_Root_R4"]
+
+
+def main():
+    store = Path(sys.argv[1]) if len(sys.argv) > 1 else Path("/etc/ssl/certs")
+    bundle = "".join((store / f"{name}.pem").read_text(encoding="ascii") for name in ROOTS)
+    lines = [
+        "#ifndef CERTIFICATES_H",
+        "#define CERTIFICATES_H",
+        "#endif",
+        "",
+        "// Сгенерировано tools/certs.py, вручную не править: " + ", ".join(ROOTS) + ".",
+        "",
+        'constexpr char HTTPS_CA_BUNDLE[] PROGMEM = R"pem(' + bundle + ')pem";',
+        "",
+    ]
+    OUTPUT.write_bytes("\n".join(lines).replace("\n", "\r\n").encode("utf-8"))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,110 @@
+#!/usr/bin/env python3
+"""Переводит двоичный журнал хаба или устройства в текст.
+
+Записи ищутся по байту LOG_MAGIC и проверяются суммой, а байты вне записей (загрузчик ESP32,
+аварийные сообщения) выводятся как есть. Тексты сообщений берутся из Common/LogMessages.h,
+поэтому журнал надо читать той же ревизией, что и прошивку.
+
+Запуск с захваченным файлом или прямо с порта:
+    python3 tools/logdecode.py capture.bin
+    python3 tools/logdecode.py /dev/ttyUSB0 115200
+"""
+
+import re
+import struct
+import sys
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+MESSAGES = ROOT / "Common" / "LogMessages.h"
+
+MAGIC = 0xA5
+ARGS_MAX = 5
+LEVELS = {1: "ERROR", 2: "WARN", 3: "INFO", 4: "DEBUG"}
+MESSAGE = re.compile(r'X\((\w+),\s*"((?:[^"\\]|\\.)*)"\)')
+SPECIFIER = re.compile(r"%[-0-9]*([duxX])")
+
+
+def messages():
+    return [text for _, text in MESSAGE.findall(MESSAGES.read_text(encoding="utf-8"))]
+
+
+def render(text, args):
+    values = iter(args)
+
+    def substitute(match):
+        value = next(values, 0)
+        if match.group(1) == "d" and value >= 1 << 31:
+            value -= 1 << 32
+        return match.group(0) % value
+
+    return SPECIFIER.sub(substitute, text)
+
+
+def decode(data, texts):
+    """Возвращает строки журнала и число байтов, которые ещё могут оказаться началом записи."""
+    lines = []
+    raw = bytearray()
+    position = 0
+    while position < len(data):
+        if data[position] != MAGIC:
+            raw.append(data[position])
+            position += 1
+            continue
+        if position + 2 > len(data):
+            break
+        count = data[position + 1] & 0x0F
+        length = 9 + 4 * count
+        if count > ARGS_MAX:
+            raw.append(data[position])
+            position += 1
+            continue
+        if position + length > len(data):
+            break
+        frame = data[position:position + length]
+        if sum(frame[:-1]) & 0xFF != frame[-1]:
+            raw.append(data[position])
+            position += 1
+            continue
+
+        if raw:
+            lines.append(raw.decode("utf-8", "replace").rstrip("\r\n"))
+            raw.clear()
+        level = LEVELS.get(frame[1] >> 4, "?")
+        message, time = struct.unpack_from("<HI", frame, 2)
+        args = struct.unpack_from(f"<{count}I", frame, 8)
+        text = render(texts[message], args) if message < len(texts) else f"message {message} {list(args)}"
+        lines.append(f"{time / 1000:10.3f} {level:5} {text}")
+        position += length
+
+    if raw:
+        lines.append(raw.decode("utf-8", "replace").rstrip("\r\n"))
+    return lines, data[position:]
+
+
+def stream(source):
+    if len(sys.argv) > 2:
+        import serial
+
+        port = serial.Serial(source, int(sys.argv[2]))
+        while True:
+            yield port.read(port.in_waiting or 1)
+    else:
+        with open(source, "rb") as file:
+            while chunk := file.read(4096):
+                yield chunk
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    texts = messages()
+    pending = b""
+    for chunk in stream(sys.argv[1]):
+        lines, pending = decode(pending + chunk, texts)
+        for line in filter(None, lines):
+            print(line, flush=True)
+
+
+if __name__ == "__main__":
+    main()
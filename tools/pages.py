@@ -0,0 +1,112 @@
+#!/usr/bin/env python3
+"""Собирает Hub/Pages.h из исходников портала настройки в Hub/pages.
+
+HTML-страница режется по плейсхолдерам %NAME% на статические сегменты, между
+которыми сервер сам пишет значения полей. Остальные файлы каталога становятся
+ассетами, заранее сжатыми gzip и отдаваемыми как есть.
+
+Запуск после правки любого файла в Hub/pages:
+    python3 tools/pages.py
+"""
+
+import gzip
+import re
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+SOURCES = ROOT / "Hub" / "pages"
+OUTPUT = ROOT / "Hub" / "Pages.h"
+
+PAGES = ["index.html"]
+ASSETS = {".css": "text/css", ".js": "application/javascript"}
+PLACEHOLDER = re.compile(r"%([A-Z_]+)%")
+
+
+def identifier(name):
+    return re.sub(r"[^A-Z0-9]", "_", name.upper())
+
+
+def raw_string(text):
+    return 'R"rawliteral(' + text + ')rawliteral"'
+
+
+def page(name, fields):
+    prefix = "PAGE_" + identifier(Path(name).stem)
+    parts = PLACEHOLDER.split((SOURCES / name).read_text(encoding="utf-8"))
+    lines = []
+    segments = []
+    for index in range(0, len(parts), 2):
+        segment = f"{prefix}_{index // 2}"
+        lines.append(f"constexpr char {segment}[] PROGMEM = {raw_string(parts[index])};")
+        field = parts[index + 1] if index + 1 < len(parts) else None
+        if field is not None and field not in fields:
+            fields.append(field)
+        segments.append((segment, "PAGE_FIELD_" + field if field else "PAGE_FIELD_NONE"))
+    lines.append("")
+    lines.append(f"constexpr PageSegment {prefix}[] = {{")
+    lines.extend(f"    {{{segment}, {field}}}," for segment, field in segments)
+    lines.append("};")
+    return lines
+
+
+def asset(path):
+    name = "ASSET_" + identifier(path.name)
+    data = gzip.compress(path.read_bytes(), compresslevel=9, mtime=0)
+    rows = [", ".join(f"0x{byte:02X}" for byte in data[i:i + 16]) for i in range(0, len(data), 16)]
+    lines = [f"constexpr uint8_t {name}_DATA[] PROGMEM = {{"]
+    lines.extend(f"    {row}," for row in rows)
+    lines.append("};")
+    return lines, f'    {{"/{path.name}", "{ASSETS[path.suffix]}", {name}_DATA, sizeof({name}_DATA)}},'
+
+
+def main():
+    fields = []
+    body = []
+    for name in PAGES:
+        body.extend(page(name, fields))
+        body.append("")
+
+    table = []
+    for path in sorted(SOURCES.iterdir()):
+        if path.suffix not in ASSETS:
+            continue
+        lines, entry = asset(path)
+        body.extend(lines)
+        body.append("")
+        table.append(entry)
+
+    lines = [
+        "#ifndef PAGES_H",
+        "#define PAGES_H",
+        "#endif",
+        "",
+        "// Сгенерировано tools/pages.py из Hub/pages, вручную не править.",
+        "",
+        "typedef enum { " + ", ".join("PAGE_FIELD_" + field for field in fields) + ", PAGE_FIELD_NONE } PageField;",
+        "",
+        "struct PageSegment {",
+        "    const char *text;",
+        "    PageField field;",
+        "};",
+        "",
+        "struct Asset {",
+        "    const char *path;",
+        "    const char *type;",
+        "    const uint8_t *data;",
+        "    size_t size;",
+        "};",
+        "",
+        *body,
+        "constexpr Asset ASSETS[] = {",
+        *table,
+        "};",
+        "",
+    ]
+    # Исходники могут быть с любыми переводами строк, а в дереве заголовки хранятся с CRLF:
+    # приводим к нему весь текст, включая сегменты страниц, чтобы повторная сборка совпадала побайтно.
+    text = "\n".join(lines).replace("\r\n", "\n").replace("\n", "\r\n")
+    OUTPUT.write_bytes(text.encode("utf-8"))
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,158 @@
+#!/usr/bin/env python3
+"""Локальный HTTPS-сервер вместо dash.wqtt.ru и api.open-meteo.com для bench/TlsBench.
+
+Отвечает на /api/broker и /v1/forecast JSON того же вида, что настоящие серверы, держит
+keep-alive и печатает каждое соединение и запрос: сколько было рукопожатий, сколько из них
+возобновили сессию и сколько запросов прошло по одному соединению.
+
+Сертификаты выпускаются openssl при первом запуске: свой корень и сертификат сервера на адрес,
+по которому к компьютеру обращается плата. Корень и адрес пишутся в bench/TlsBench/BenchCa.h,
+после чего скетч собирается и прошивается:
+    python3 tools/tlsserver.py 192.168.1.10 [порт]
+"""
+
+import http.server
+import json
+import ssl
+import subprocess
+import sys
+from pathlib import Path
+
+ROOT = Path(__file__).resolve().parent.parent
+SKETCH = ROOT / "bench" / "TlsBench"
+CERTS = SKETCH / "certs"
+HEADER = SKETCH / "BenchCa.h"
+
+DEFAULT_PORT = 8443
+FORECAST_START = 1780272000
+
+
+def openssl(*args):
+    subprocess.run(["openssl", *args], check=True, capture_output=True)
+
+
+def certificates(host):
+    """Возвращает пути к сертификату и ключу сервера для host; корень общий для всех адресов."""
+    CERTS.mkdir(parents=True, exist_ok=True)
+    ca, ca_key = CERTS / "ca.pem", CERTS / "ca.key"
+    if not ca.exists():
+        openssl("req", "-x509", "-newkey", "rsa:2048", "-nodes", "-days", "3650", "-subj", "/CN=Irrigation bench CA",
+                "-addext", "basicConstraints=critical,CA:TRUE", "-addext", "keyUsage=critical,keyCertSign,cRLSign",
+                "-keyout", str(ca_key), "-out", str(ca))
+
+    cert, key = CERTS / f"server-{host}.pem", CERTS / f"server-{host}.key"
+    if not cert.exists():
+        request = CERTS / f"server-{host}.csr"
+        extensions = CERTS / f"server-{host}.ext"
+        names = f"DNS:{host},IP:{host}" if host.replace(".", "").isdigit() else f"DNS:{host}"
+        extensions.write_text(f"subjectAltName={names}\nextendedKeyUsage=serverAuth\n", encoding="ascii")
+        openssl("req", "-newkey", "rsa:2048", "-nodes", "-subj", f"/CN={host}", "-keyout", str(key), "-out", str(request))
+        openssl("x509", "-req", "-days", "3650", "-in", str(request), "-CA", str(ca), "-CAkey", str(ca_key),
+                "-CAcreateserial", "-extfile", str(extensions), "-out", str(cert))
+    return ca, cert, key
+
+
+def header(ca, host, port):
+    lines = [
+        "#ifndef BENCH_CA_H",
+        "#define BENCH_CA_H",
+        "#endif",
+        "",
+        "// Сгенерировано tools/tlsserver.py, вручную не править.",
+        "",
+        f'constexpr char BENCH_HOST[] = "{host}";',
+        f"constexpr uint16_t BENCH_PORT = {port};",
+        'constexpr char BENCH_CA[] PROGMEM = R"pem(' + ca.read_text(encoding="ascii") + ')pem";',
+        "",
+    ]
+    HEADER.write_bytes("\n".join(lines).replace("\n", "\r\n").encode("utf-8"))
+
+
+BROKER = {"server": "m5.wqtt.ru", "port": 5361, "ssl_port": 5362, "user": "u_8KX2QF", "password": "Jq7vZ0tPb3sWn1Lc"}
+
+FORECAST = {
+    "latitude": 55.75, "longitude": 37.625, "generationtime_ms": 0.022, "utc_offset_seconds": 0, "timezone": "GMT",
+    "timezone_abbreviation": "GMT", "elevation": 144.0,
+    "current_units": {"time": "unixtime", "interval": "seconds", "rain": "mm"},
+    "current": {"time": FORECAST_START, "interval": 900, "rain": 0.0},
+    "hourly_units": {"time": "unixtime", "rain": "mm"},
+    "hourly": {"time": [FORECAST_START + hour * 3600 for hour in range(24)],
+               "rain": [0.4 if hour % 7 == 3 else 0.0 for hour in range(24)]},
+}
+
+ROUTES = {"/api/broker": BROKER, "/v1/forecast": FORECAST}
+
+
+class Server(http.server.ThreadingHTTPServer):
+    daemon_threads = True
+
+    def __init__(self, address, context):
+        super().__init__(address, Handler)
+        self.context = context
+        self.connections = 0
+        self.resumed = 0
+        self.requests = 0
+
+    # Рукопожатие идёт в потоке соединения, чтобы медленный клиент не задерживал приём следующих.
+    def finish_request(self, request, client_address):
+        try:
+            request = self.context.wrap_socket(request, server_side=True)
+        except (ssl.SSLError, OSError) as error:
+            print(f"{client_address[0]} handshake failed: {error}", flush=True)
+            return
+        self.connections += 1
+        self.resumed += request.session_reused
+        print(f"{client_address[0]} handshake {self.connections}{' (resumed)' if request.session_reused else ''}, "
+              f"{request.version()}", flush=True)
+        try:
+            super().finish_request(request, client_address)
+        finally:
+            request.close()
+
+    def summary(self):
+        print(f"{self.connections} handshakes ({self.resumed} resumed), {self.requests} requests", flush=True)
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    # Обработчик живёт, пока живёт соединение, поэтому счётчик — запросы одного соединения.
+    served = 0
+
+    def do_GET(self):
+        self.server.requests += 1
+        self.served += 1
+        body = ROUTES.get(self.path.split("?")[0])
+        data = json.dumps(body, separators=(",", ":")).encode() if body else b"{}"
+        self.send_response(200 if body else 404)
+        self.send_header("Content-Type", "application/json")
+        self.send_header("Content-Length", str(len(data)))
+        self.end_headers()
+        self.wfile.write(data)
+        print(f"  {self.path.split('?')[0]} request {self.served} on this connection", flush=True)
+
+    def log_message(self, format, *args):
+        pass
+
+
+def main():
+    if len(sys.argv) < 2:
+        sys.exit(__doc__)
+    host = sys.argv[1]
+    port = int(sys.argv[2]) if len(sys.argv) > 2 else DEFAULT_PORT
+
+    ca, cert, key = certificates(host)
+    header(ca, host, port)
+    context = ssl.create_default_context(ssl.Purpose.CLIENT_AUTH)
+    context.load_cert_chain(cert, key)
+
+    server = Server(("", port), context)
+    print(f"Listening on {host}:{port}; {HEADER.relative_to(ROOT)} is up to date", flush=True)
+    try:
+        server.serve_forever()
+    except KeyboardInterrupt:
+        pass
+    server.summary()
+
+
+if __name__ == "__main__":
+    main()